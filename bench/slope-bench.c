@@ -0,0 +1,592 @@
+/*
+ * Copyright (C) 2017,2023  Elvis Teixeira, Anatoliy Sokolov
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* slope-bench draws generated figures into image surfaces, without
+ * a display, and reports the time per point and the frames per
+ * second for every scene, number of points and figure size asked:
+ *
+ *   line     one line series
+ *   circles  one series of small filled circles
+ *   area     one series filled down to the x axis
+ *   axes     a 4x4 grid of scales with framed and gridded axes,
+ *            the points split among them
+ *   legend   24 line series splitting the points, with the
+ *            legends of the scale and of the figure shown
+ *
+ * Every figure is drawn from scratch each frame, as an export or a
+ * resized view would. The data is a seeded random walk, so runs
+ * are comparable.
+ *
+ * --json writes the results to a file, one result per line, that a
+ * later run reads with --baseline to print how each result changed.
+ * The exit status is then 1 if a frame got slower than --threshold
+ * percent.
+ *
+ * usage: slope-bench [OPTION...]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <slope/slope.h>
+
+#define BENCH_SEED 20171227
+/* series of the legend scene */
+#define BENCH_LEGEND_SERIES 24
+/* scales per side in the axes scene */
+#define BENCH_AXES_GRID 4
+
+typedef struct _BenchScene
+{
+  const char *name;
+  void (*build)(SlopeFigure *figure, long n_pts);
+} BenchScene;
+
+typedef struct _BenchResult
+{
+  char             scene[32];
+  long             n_pts;
+  int              width;
+  int              height;
+  long             frames;
+  double           seconds;
+  double           ns_per_point;
+  double           fps;
+  SlopeRenderStats stats;
+} BenchResult;
+
+static void bench_build_line(SlopeFigure *figure, long n_pts);
+static void bench_build_circles(SlopeFigure *figure, long n_pts);
+static void bench_build_area(SlopeFigure *figure, long n_pts);
+static void bench_build_axes(SlopeFigure *figure, long n_pts);
+static void bench_build_legend(SlopeFigure *figure, long n_pts);
+
+static const BenchScene bench_scene_list[] = {
+  {"line", bench_build_line},
+  {"circles", bench_build_circles},
+  {"area", bench_build_area},
+  {"axes", bench_build_axes},
+  {"legend", bench_build_legend},
+  {NULL, NULL}
+};
+
+static const char *bench_stage_names[SLOPE_RENDER_N_STAGES] = {
+  "background", "scales", "items", "axes", "legend", "total"
+};
+
+static char *   bench_scenes    = NULL;
+static char *   bench_points    = NULL;
+static char *   bench_sizes     = NULL;
+static double   bench_min_time  = 0.5;
+static char *   bench_json      = NULL;
+static char *   bench_baseline  = NULL;
+static double   bench_threshold = 10.0;
+static gboolean bench_stages    = FALSE;
+
+static double *bench_x_vec = NULL;
+static double *bench_y_vec = NULL;
+
+static GOptionEntry bench_options[] = {
+  {"scenes", 's', 0, G_OPTION_ARG_STRING, &bench_scenes,
+   "Comma separated scenes (default: line,circles,area,axes,legend)", "LIST"},
+  {"points", 'n', 0, G_OPTION_ARG_STRING, &bench_points,
+   "Comma separated point counts (default: 1e3,1e4,1e5,1e6,1e7)", "LIST"},
+  {"sizes", 'S', 0, G_OPTION_ARG_STRING, &bench_sizes,
+   "Comma separated figure sizes (default: 640x480,1920x1080)", "LIST"},
+  {"time", 't', 0, G_OPTION_ARG_DOUBLE, &bench_min_time,
+   "Seconds spent drawing each case (default: 0.5)", "SECONDS"},
+  {"json", 'o', 0, G_OPTION_ARG_FILENAME, &bench_json,
+   "Write the results to FILE", "FILE"},
+  {"baseline", 'b', 0, G_OPTION_ARG_FILENAME, &bench_baseline,
+   "Compare with the results saved in FILE", "FILE"},
+  {"threshold", 'T', 0, G_OPTION_ARG_DOUBLE, &bench_threshold,
+   "Percent of frame time beyond which a change is a regression (default: 10)",
+   "PERCENT"},
+  {"stages", 0, 0, G_OPTION_ARG_NONE, &bench_stages,
+   "Profile the figures and report the time of each stage", NULL},
+  {NULL, 0, 0, 0, NULL, NULL, NULL}
+};
+
+static gboolean bench_make_data(long n_pts)
+{
+  GRand *rand;
+  double y = 0.0;
+  long   k;
+
+  bench_x_vec = g_try_new(double, n_pts);
+  bench_y_vec = g_try_new(double, n_pts);
+  if (bench_x_vec == NULL || bench_y_vec == NULL)
+    {
+      return FALSE;
+    }
+  rand = g_rand_new_with_seed(BENCH_SEED);
+  for (k = 0L; k < n_pts; ++k)
+    {
+      y += g_rand_double_range(rand, -1.0, 1.0);
+      bench_x_vec[k] = (double) k;
+      bench_y_vec[k] = y;
+    }
+  g_rand_free(rand);
+  return TRUE;
+}
+
+static SlopeScale *bench_add_scale(SlopeFigure *figure,
+                                   const char * title,
+                                   const char * style,
+                                   long         n_pts)
+{
+  SlopeScale *scale = slope_xyscale_new_axis("x", "y", title);
+  slope_figure_add_scale(figure, scale);
+  slope_scale_add_item(
+      scale, slope_xyseries_new_filled(title, bench_x_vec, bench_y_vec, n_pts, style));
+  return scale;
+}
+
+static void bench_build_line(SlopeFigure *figure, long n_pts)
+{
+  bench_add_scale(figure, "line", "b-", n_pts);
+}
+
+static void bench_build_circles(SlopeFigure *figure, long n_pts)
+{
+  bench_add_scale(figure, "circles", "ro", n_pts);
+}
+
+static void bench_build_area(SlopeFigure *figure, long n_pts)
+{
+  bench_add_scale(figure, "area", "ga", n_pts);
+}
+
+static void bench_build_axes(SlopeFigure *figure, long n_pts)
+{
+  long n_each = SLOPE_MAX(n_pts / (BENCH_AXES_GRID * BENCH_AXES_GRID), 2L);
+  char title[32];
+  int  row, col;
+
+  for (row = 0; row < BENCH_AXES_GRID; ++row)
+    {
+      for (col = 0; col < BENCH_AXES_GRID; ++col)
+        {
+          SlopeScale *scale = slope_xyscale_new_axis("x", "y", NULL);
+          g_snprintf(title, sizeof(title), "scale %d", row * BENCH_AXES_GRID + col);
+          slope_scale_set_name(scale, title);
+          slope_scale_set_show_name(scale, TRUE);
+          slope_scale_set_layout_rect(scale, col, row, 1, 1);
+          slope_xyscale_set_axis(SLOPE_XYSCALE(scale), SLOPE_XYSCALE_FRAME_AXIS_GRID);
+          slope_item_set_is_visible(slope_scale_get_legend(scale), FALSE);
+          slope_figure_add_scale(figure, scale);
+          slope_scale_add_item(
+              scale,
+              slope_xyseries_new_filled(title, bench_x_vec, bench_y_vec, n_each, "b-"));
+        }
+    }
+}
+
+static void bench_build_legend(SlopeFigure *figure, long n_pts)
+{
+  static const char colors[] = "rgbmylt";
+  long       n_each = SLOPE_MAX(n_pts / BENCH_LEGEND_SERIES, 2L);
+  SlopeScale *scale = slope_xyscale_new_axis("x", "y", "legend");
+  char       name[32], style[3];
+  int        k;
+
+  slope_figure_add_scale(figure, scale);
+  for (k = 0; k < BENCH_LEGEND_SERIES; ++k)
+    {
+      g_snprintf(name, sizeof(name), "series %d", k);
+      style[0] = colors[k % 7];
+      style[1] = '-';
+      style[2] = '\0';
+      slope_scale_add_item(scale,
+                           slope_xyseries_new_filled(name,
+                                                     bench_x_vec + k * n_each,
+                                                     bench_y_vec + k * n_each,
+                                                     n_each,
+                                                     style));
+    }
+  slope_item_set_is_visible(slope_figure_get_legend(figure), TRUE);
+}
+
+static void bench_draw(SlopeFigure *figure, cairo_t *cr, int width, int height)
+{
+  cairo_save(cr);
+  cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
+  cairo_paint(cr);
+  cairo_restore(cr);
+  slope_figure_draw(figure, &GRAPHENE_RECT_INIT (0.0, 0.0, width, height), cr);
+}
+
+static gboolean bench_run(const BenchScene *scene,
+                          long              n_pts,
+                          int               width,
+                          int               height,
+                          BenchResult *     result)
+{
+  SlopeFigure *    figure;
+  cairo_surface_t *surface;
+  cairo_t *        cr;
+  gint64           begin, elapsed;
+  long             frames = 0L;
+
+  surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+  if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS)
+    {
+      cairo_surface_destroy(surface);
+      return FALSE;
+    }
+  cr     = cairo_create(surface);
+  figure = slope_figure_new();
+  slope_figure_set_frame_mode(figure, SLOPE_FIGURE_RECTANGLE);
+  slope_figure_set_profiling(figure, bench_stages);
+  scene->build(figure, n_pts);
+
+  /* the first frame fills the font and stamp caches */
+  bench_draw(figure, cr, width, height);
+  begin = g_get_monotonic_time();
+  do
+    {
+      bench_draw(figure, cr, width, height);
+      frames += 1L;
+      elapsed = g_get_monotonic_time() - begin;
+    }
+  while (elapsed < (gint64) (bench_min_time * G_USEC_PER_SEC));
+
+  g_strlcpy(result->scene, scene->name, sizeof(result->scene));
+  result->n_pts        = n_pts;
+  result->width        = width;
+  result->height       = height;
+  result->frames       = frames;
+  result->seconds      = elapsed * 1.0e-6;
+  result->ns_per_point = elapsed * 1.0e3 / ((double) frames * n_pts);
+  result->fps          = frames / result->seconds;
+  memset(&result->stats, 0, sizeof(SlopeRenderStats));
+  slope_figure_get_render_stats(figure, &result->stats);
+
+  g_object_unref(figure);
+  cairo_destroy(cr);
+  cairo_surface_destroy(surface);
+  return TRUE;
+}
+
+static const BenchScene *bench_find_scene(const char *name)
+{
+  int k;
+  for (k = 0; bench_scene_list[k].name != NULL; ++k)
+    {
+      if (strcmp(bench_scene_list[k].name, name) == 0)
+        {
+          return &bench_scene_list[k];
+        }
+    }
+  return NULL;
+}
+
+static gboolean bench_parse_points(const char *list, GArray *points)
+{
+  char **tokens = g_strsplit(list, ",", -1);
+  char * end;
+  double value;
+  int    k;
+  for (k = 0; tokens[k] != NULL; ++k)
+    {
+      long n_pts;
+      value = g_ascii_strtod(tokens[k], &end);
+      if (end == tokens[k] || *end != '\0' || !(value >= 2.0))
+        {
+          g_printerr("slope-bench: bad point count '%s'\n", tokens[k]);
+          g_strfreev(tokens);
+          return FALSE;
+        }
+      n_pts = (long) value;
+      g_array_append_val(points, n_pts);
+    }
+  g_strfreev(tokens);
+  return TRUE;
+}
+
+static gboolean bench_parse_sizes(const char *list, GArray *sizes)
+{
+  char **tokens = g_strsplit(list, ",", -1);
+  int    size[2];
+  int    k;
+  for (k = 0; tokens[k] != NULL; ++k)
+    {
+      if (sscanf(tokens[k], "%dx%d", &size[0], &size[1]) != 2
+          || size[0] <= 0 || size[1] <= 0)
+        {
+          g_printerr("slope-bench: bad figure size '%s'\n", tokens[k]);
+          g_strfreev(tokens);
+          return FALSE;
+        }
+      g_array_append_vals(sizes, size, 2);
+    }
+  g_strfreev(tokens);
+  return TRUE;
+}
+
+static void bench_print_result(const BenchResult *result)
+{
+  int k;
+  g_print("%-8s %10ld %5dx%-5d %7ld %12.3f %10.2f",
+          result->scene,
+          result->n_pts,
+          result->width,
+          result->height,
+          result->frames,
+          result->ns_per_point,
+          result->fps);
+  if (bench_stages)
+    {
+      for (k = 0; k < SLOPE_RENDER_N_STAGES; ++k)
+        {
+          g_print(" %s=%.2fms", bench_stage_names[k], result->stats.stage_time[k] * 1.0e-3);
+        }
+    }
+  g_print("\n");
+}
+
+static gboolean bench_write_json(const char *path, GArray *results)
+{
+  FILE *file = fopen(path, "w");
+  guint k;
+  int   s;
+  if (file == NULL)
+    {
+      return FALSE;
+    }
+  /* one result per line, --baseline reads it back that way */
+  fprintf(file, "{\n  \"version\": 1,\n  \"results\": [\n");
+  for (k = 0; k < results->len; ++k)
+    {
+      const BenchResult *result = &g_array_index(results, BenchResult, k);
+      fprintf(file,
+              "    {\"scene\": \"%s\", \"points\": %ld, \"width\": %d, \"height\": %d, "
+              "\"frames\": %ld, \"seconds\": %.6f, \"ns_per_point\": %.6f, \"fps\": %.6f",
+              result->scene,
+              result->n_pts,
+              result->width,
+              result->height,
+              result->frames,
+              result->seconds,
+              result->ns_per_point,
+              result->fps);
+      if (bench_stages)
+        {
+          fprintf(file, ", \"stage_ms\": {");
+          for (s = 0; s < SLOPE_RENDER_N_STAGES; ++s)
+            {
+              fprintf(file, "%s\"%s\": %.6f", (s > 0) ? ", " : "",
+                      bench_stage_names[s], result->stats.stage_time[s] * 1.0e-3);
+            }
+          fprintf(file, "}, \"points_mapped\": %" G_GUINT64_FORMAT
+                  ", \"segments\": %" G_GUINT64_FORMAT ", \"markers\": %" G_GUINT64_FORMAT,
+                  result->stats.points, result->stats.segments, result->stats.markers);
+        }
+      fprintf(file, "}%s\n", (k + 1 < results->len) ? "," : "");
+    }
+  fprintf(file, "  ]\n}\n");
+  return fclose(file) == 0;
+}
+
+static GArray *bench_read_baseline(const char *path)
+{
+  GArray *baseline;
+  char *  contents;
+  char ** lines;
+  int     k;
+  if (!g_file_get_contents(path, &contents, NULL, NULL))
+    {
+      return NULL;
+    }
+  baseline = g_array_new(FALSE, TRUE, sizeof(BenchResult));
+  lines    = g_strsplit(contents, "\n", -1);
+  for (k = 0; lines[k] != NULL; ++k)
+    {
+      BenchResult result;
+      memset(&result, 0, sizeof(BenchResult));
+      if (sscanf(lines[k],
+                 " {\"scene\": \"%31[^\"]\", \"points\": %ld, \"width\": %d, \"height\": %d, "
+                 "\"frames\": %ld, \"seconds\": %lf, \"ns_per_point\": %lf, \"fps\": %lf",
+                 result.scene,
+                 &result.n_pts,
+                 &result.width,
+                 &result.height,
+                 &result.frames,
+                 &result.seconds,
+                 &result.ns_per_point,
+                 &result.fps) == 8)
+        {
+          g_array_append_val(baseline, result);
+        }
+    }
+  g_strfreev(lines);
+  g_free(contents);
+  return baseline;
+}
+
+static int bench_compare(GArray *results, GArray *baseline)
+{
+  int   n_slower = 0;
+  guint k, j;
+
+  g_print("\n%-8s %10s %11s %12s %12s %8s\n",
+          "scene", "points", "size", "base ns/pt", "ns/pt", "change");
+  for (k = 0; k < results->len; ++k)
+    {
+      const BenchResult *result = &g_array_index(results, BenchResult, k);
+      for (j = 0; j < baseline->len; ++j)
+        {
+          const BenchResult *base = &g_array_index(baseline, BenchResult, j);
+          double             change;
+          if (strcmp(base->scene, result->scene) != 0 || base->n_pts != result->n_pts
+              || base->width != result->width || base->height != result->height)
+            {
+              continue;
+            }
+          /* positive when frames take longer than they did */
+          change = (result->ns_per_point / base->ns_per_point - 1.0) * 100.0;
+          g_print("%-8s %10ld %5dx%-5d %12.3f %12.3f %+7.1f%%%s\n",
+                  result->scene,
+                  result->n_pts,
+                  result->width,
+                  result->height,
+                  base->ns_per_point,
+                  result->ns_per_point,
+                  change,
+                  (change > bench_threshold) ? "  slower" : "");
+          if (change > bench_threshold)
+            {
+              n_slower += 1;
+            }
+          break;
+        }
+    }
+  return n_slower;
+}
+
+int main(int argc, char *argv[])
+{
+  GOptionContext *context;
+  GError *        error = NULL;
+  GArray *        points, *sizes, *results, *baseline = NULL;
+  char **         scenes;
+  long            max_pts;
+  guint           p, s;
+  int             k, status = 0;
+
+  context = g_option_context_new("- measure how fast slope draws figures");
+  g_option_context_add_main_entries(context, bench_options, NULL);
+  if (!g_option_context_parse(context, &argc, &argv, &error))
+    {
+      g_printerr("slope-bench: %s\n", error->message);
+      g_error_free(error);
+      g_option_context_free(context);
+      return 2;
+    }
+  g_option_context_free(context);
+
+  points  = g_array_new(FALSE, FALSE, sizeof(long));
+  sizes   = g_array_new(FALSE, FALSE, sizeof(int));
+  results = g_array_new(FALSE, TRUE, sizeof(BenchResult));
+  scenes  = g_strsplit((bench_scenes != NULL) ? bench_scenes
+                                              : "line,circles,area,axes,legend", ",", -1);
+  if (!bench_parse_points((bench_points != NULL) ? bench_points : "1e3,1e4,1e5,1e6,1e7", points)
+      || !bench_parse_sizes((bench_sizes != NULL) ? bench_sizes : "640x480,1920x1080", sizes))
+    {
+      return 2;
+    }
+  for (k = 0; scenes[k] != NULL; ++k)
+    {
+      if (bench_find_scene(scenes[k]) == NULL)
+        {
+          g_printerr("slope-bench: unknown scene '%s'\n", scenes[k]);
+          return 2;
+        }
+    }
+  if (bench_baseline != NULL)
+    {
+      baseline = bench_read_baseline(bench_baseline);
+      if (baseline == NULL)
+        {
+          g_printerr("slope-bench: could not read %s\n", bench_baseline);
+          return 2;
+        }
+    }
+  /* the legend scene takes two points per series at least */
+  max_pts = 2L * BENCH_LEGEND_SERIES;
+  for (p = 0; p < points->len; ++p)
+    {
+      max_pts = SLOPE_MAX(max_pts, g_array_index(points, long, p));
+    }
+  if (!bench_make_data(max_pts))
+    {
+      g_printerr("slope-bench: not enough memory for %ld points\n", max_pts);
+      return 1;
+    }
+
+  g_print("%-8s %10s %11s %7s %12s %10s\n",
+          "scene", "points", "size", "frames", "ns/point", "frames/s");
+  for (k = 0; scenes[k] != NULL; ++k)
+    {
+      for (p = 0; p < points->len; ++p)
+        {
+          for (s = 0; s < sizes->len; s += 2)
+            {
+              BenchResult result;
+              if (!bench_run(bench_find_scene(scenes[k]),
+                             g_array_index(points, long, p),
+                             g_array_index(sizes, int, s),
+                             g_array_index(sizes, int, s + 1),
+                             &result))
+                {
+                  g_printerr("slope-bench: could not create a %dx%d image\n",
+                             g_array_index(sizes, int, s),
+                             g_array_index(sizes, int, s + 1));
+                  status = 1;
+                  continue;
+                }
+              bench_print_result(&result);
+              g_array_append_val(results, result);
+            }
+        }
+    }
+
+  if (bench_json != NULL && !bench_write_json(bench_json, results))
+    {
+      g_printerr("slope-bench: could not write %s\n", bench_json);
+      status = 1;
+    }
+  if (baseline != NULL && bench_compare(results, baseline) > 0)
+    {
+      status = 1;
+    }
+
+  if (baseline != NULL)
+    {
+      g_array_free(baseline, TRUE);
+    }
+  g_array_free(results, TRUE);
+  g_array_free(sizes, TRUE);
+  g_array_free(points, TRUE);
+  g_strfreev(scenes);
+  g_free(bench_x_vec);
+  g_free(bench_y_vec);
+  return status;
+}
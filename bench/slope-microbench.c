@@ -0,0 +1,579 @@
+/*
+ * Copyright (C) 2017,2023  Elvis Teixeira, Anatoliy Sokolov
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* slope-microbench times the hot paths under the drawing on their
+ * own, to check a change to one of them without the noise of a
+ * whole frame:
+ *
+ *   map            slope_scale_map() of an xy scale, per point
+ *   unmap          slope_scale_unmap() of an xy scale, per point
+ *   map_array      slope_scale_map_array() of an xy scale, per point
+ *   map_int16      the same from int16 y samples, converted on the
+ *                  fly, per point
+ *   bounds         the min/max scan of slope_xyseries_update(),
+ *                  per point
+ *   update         all of slope_xyseries_update(), per point
+ *   sample         slope_sampler_auto_sample_decimal(), per call
+ *   legend         measuring the names of a 24 entries legend,
+ *                  per call
+ *
+ * The process is pinned to one CPU (Linux only). Each case is
+ * calibrated to take about --trial-time per trial, then timed for
+ * --trials trials, reporting the fastest, median and mean trial and
+ * the spread. --json and --baseline work as in slope-bench, the
+ * medians are compared.
+ *
+ * It calls into private functions of the library, so it must run
+ * against the libslope it was built with.
+ *
+ * usage: slope-microbench [OPTION...]
+ */
+
+#ifdef __linux__
+#define _GNU_SOURCE
+#include <sched.h>
+#endif
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <slope/slope.h>
+#include <slope/sampler.h>
+#include <slope/legend_p.h>
+#include <slope/samples_p.h>
+#include <slope/simd_p.h>
+
+#define MICRO_SEED 20171227
+/* points of the per point cases, enough to leave the L2 cache */
+#define MICRO_N_PTS (1L << 20)
+/* points mapped by each call of the map cases */
+#define MICRO_MAP_CHUNK 4096L
+#define MICRO_LEGEND_ITEMS 24
+
+typedef struct _MicroData
+{
+  double *          x_vec;
+  double *          y_vec;
+  gint16 *          y_raw;
+  graphene_point_t *points;
+  SlopeFigure *     figure;
+  SlopeScale *      scale;
+  SlopeItem *       series;
+  SlopeItem *       legend;
+  GPtrArray *       legend_items;
+  SlopeSampler *    sampler;
+  cairo_surface_t * surface;
+  cairo_t *         cr;
+  long              cursor;
+} MicroData;
+
+typedef struct _MicroCase
+{
+  const char *name;
+  /* what one operation is */
+  const char *unit;
+  /* runs the code once, returning the operations done */
+  long (*run)(MicroData *data);
+} MicroCase;
+
+typedef struct _MicroResult
+{
+  char   name[32];
+  char   unit[16];
+  int    trials;
+  double min_ns;
+  double median_ns;
+  double mean_ns;
+  double stddev_ns;
+} MicroResult;
+
+static long micro_run_map(MicroData *data);
+static long micro_run_unmap(MicroData *data);
+static long micro_run_map_array(MicroData *data);
+static long micro_run_map_int16(MicroData *data);
+static long micro_run_bounds(MicroData *data);
+static long micro_run_update(MicroData *data);
+static long micro_run_sample(MicroData *data);
+static long micro_run_legend(MicroData *data);
+
+static const MicroCase micro_case_list[] = {
+  {"map", "point", micro_run_map},
+  {"unmap", "point", micro_run_unmap},
+  {"map_array", "point", micro_run_map_array},
+  {"map_int16", "point", micro_run_map_int16},
+  {"bounds", "point", micro_run_bounds},
+  {"update", "point", micro_run_update},
+  {"sample", "call", micro_run_sample},
+  {"legend", "call", micro_run_legend},
+  {NULL, NULL, NULL}
+};
+
+static char * micro_cases      = NULL;
+static int    micro_cpu        = 0;
+static int    micro_trials     = 21;
+static double micro_trial_time = 0.02;
+static char * micro_json       = NULL;
+static char * micro_baseline   = NULL;
+static double micro_threshold  = 5.0;
+
+/* keeps the compiler from dropping the work of the cases */
+static volatile double micro_sink = 0.0;
+
+static GOptionEntry micro_options[] = {
+  {"cases", 'c', 0, G_OPTION_ARG_STRING, &micro_cases,
+   "Comma separated cases (default: all)", "LIST"},
+  {"cpu", 0, 0, G_OPTION_ARG_INT, &micro_cpu,
+   "CPU to run on, -1 to leave it to the system (default: 0)", "CPU"},
+  {"trials", 'r', 0, G_OPTION_ARG_INT, &micro_trials,
+   "Timed trials of each case (default: 21)", "N"},
+  {"trial-time", 't', 0, G_OPTION_ARG_DOUBLE, &micro_trial_time,
+   "Seconds each trial should last (default: 0.02)", "SECONDS"},
+  {"json", 'o', 0, G_OPTION_ARG_FILENAME, &micro_json,
+   "Write the results to FILE", "FILE"},
+  {"baseline", 'b', 0, G_OPTION_ARG_FILENAME, &micro_baseline,
+   "Compare with the results saved in FILE", "FILE"},
+  {"threshold", 'T', 0, G_OPTION_ARG_DOUBLE, &micro_threshold,
+   "Percent of median time beyond which a change is a regression (default: 5)",
+   "PERCENT"},
+  {NULL, 0, 0, 0, NULL, NULL, NULL}
+};
+
+static gboolean micro_pin_cpu(int cpu)
+{
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+  SLOPE_UNUSED(cpu);
+  return FALSE;
+#endif
+}
+
+static void micro_data_init(MicroData *data)
+{
+  GRand *rand = g_rand_new_with_seed(MICRO_SEED);
+  char   name[32];
+  long   k;
+
+  data->x_vec  = g_new(double, MICRO_N_PTS);
+  data->y_vec  = g_new(double, MICRO_N_PTS);
+  data->y_raw  = g_new(gint16, MICRO_N_PTS);
+  data->points = g_new(graphene_point_t, MICRO_N_PTS);
+  for (k = 0L; k < MICRO_N_PTS; ++k)
+    {
+      data->x_vec[k]  = (double) k;
+      data->y_vec[k]  = g_rand_double_range(rand, -1.0, 1.0);
+      data->y_raw[k]  = (gint16) (data->y_vec[k] * 32767.0);
+      data->points[k] = GRAPHENE_POINT_INIT (g_rand_double_range(rand, 0.0, 640.0),
+                                             g_rand_double_range(rand, 0.0, 480.0));
+    }
+  g_rand_free(rand);
+
+  /* the scale only knows its figure rectangle once drawn */
+  data->surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 640, 480);
+  data->cr      = cairo_create(data->surface);
+  cairo_select_font_face(
+      data->cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+  cairo_set_font_size(data->cr, 11);
+  data->figure = slope_figure_new();
+  data->scale  = slope_xyscale_new_axis("x", "y", "micro");
+  data->series = slope_xyseries_new_filled(
+      "series", data->x_vec, data->y_vec, MICRO_N_PTS, "b-");
+  slope_figure_add_scale(data->figure, data->scale);
+  slope_scale_add_item(data->scale, data->series);
+  slope_figure_draw(data->figure, &GRAPHENE_RECT_INIT (0.0, 0.0, 640.0, 480.0), data->cr);
+
+  data->legend       = slope_legend_new(GTK_ORIENTATION_VERTICAL);
+  data->legend_items = g_ptr_array_new_with_free_func(g_object_unref);
+  for (k = 0L; k < MICRO_LEGEND_ITEMS; ++k)
+    {
+      SlopeItem *item = slope_xyseries_new();
+      g_snprintf(name, sizeof(name), "measured series %ld", k);
+      slope_item_set_name(item, name);
+      slope_legend_add_item(SLOPE_LEGEND(data->legend), item);
+      g_ptr_array_add(data->legend_items, item);
+    }
+  data->sampler = slope_sampler_new();
+  data->cursor  = 0L;
+}
+
+static void micro_data_clear(MicroData *data)
+{
+  slope_sampler_destroy(data->sampler);
+  g_object_unref(data->legend);
+  g_ptr_array_free(data->legend_items, TRUE);
+  g_object_unref(data->figure);
+  cairo_destroy(data->cr);
+  cairo_surface_destroy(data->surface);
+  g_free(data->points);
+  g_free(data->x_vec);
+  g_free(data->y_vec);
+  g_free(data->y_raw);
+}
+
+static long micro_next_chunk(MicroData *data)
+{
+  long k0 = data->cursor;
+  data->cursor = (k0 + MICRO_MAP_CHUNK < MICRO_N_PTS) ? k0 + MICRO_MAP_CHUNK : 0L;
+  return k0;
+}
+
+static long micro_run_map(MicroData *data)
+{
+  graphene_point_t res, src;
+  double           sum = 0.0;
+  long             k0  = micro_next_chunk(data);
+  long             k;
+  for (k = k0; k < k0 + MICRO_MAP_CHUNK; ++k)
+    {
+      src = GRAPHENE_POINT_INIT (data->x_vec[k], data->y_vec[k]);
+      slope_scale_map(data->scale, &res, &src);
+      sum += res.x + res.y;
+    }
+  micro_sink = sum;
+  return MICRO_MAP_CHUNK;
+}
+
+static long micro_run_unmap(MicroData *data)
+{
+  graphene_point_t res;
+  double           sum = 0.0;
+  long             k0  = micro_next_chunk(data);
+  long             k;
+  for (k = k0; k < k0 + MICRO_MAP_CHUNK; ++k)
+    {
+      slope_scale_unmap(data->scale, &res, &data->points[k]);
+      sum += res.x + res.y;
+    }
+  micro_sink = sum;
+  return MICRO_MAP_CHUNK;
+}
+
+static long micro_run_map_array(MicroData *data)
+{
+  long k0 = micro_next_chunk(data);
+  slope_scale_map_array(
+      data->scale, data->points + k0, data->x_vec + k0, data->y_vec + k0, MICRO_MAP_CHUNK);
+  micro_sink = data->points[k0].x;
+  return MICRO_MAP_CHUNK;
+}
+
+static long micro_run_map_int16(MicroData *data)
+{
+  SlopeSamples x, y;
+  long         k0 = micro_next_chunk(data);
+  _samples_init(&x, data->x_vec, SLOPE_SAMPLE_DOUBLE, 1.0, 0.0);
+  _samples_init(&y, data->y_raw, SLOPE_SAMPLE_INT16, 1.0 / 32767.0, 0.0);
+  _samples_map(data->scale, data->points + k0, &x, &y, k0, MICRO_MAP_CHUNK);
+  micro_sink = data->points[k0].x;
+  return MICRO_MAP_CHUNK;
+}
+
+static long micro_run_bounds(MicroData *data)
+{
+  double   x_min, x_max, y_min, y_max;
+  gboolean sorted;
+  _simd_bounds(
+      data->x_vec, data->y_vec, MICRO_N_PTS, &x_min, &x_max, &y_min, &y_max, &sorted);
+  micro_sink = x_min + x_max + y_min + y_max + sorted;
+  return MICRO_N_PTS;
+}
+
+static long micro_run_update(MicroData *data)
+{
+  slope_xyseries_update(SLOPE_XYSERIES(data->series));
+  return MICRO_N_PTS;
+}
+
+static long micro_run_sample(MicroData *data)
+{
+  /* ranges over many decades, like zooming does */
+  double span = pow(10.0, (double) (data->cursor++ % 24) - 12.0);
+  slope_sampler_auto_sample_decimal(data->sampler, -0.3 * span, 1.7 * span, 8.0);
+  micro_sink = g_list_length(slope_sampler_get_sample_list(data->sampler));
+  return 1L;
+}
+
+static long micro_run_legend(MicroData *data)
+{
+  _legend_evaluate_extents(data->legend, data->cr);
+  return 1L;
+}
+
+static int micro_compare_double(const void *a, const void *b)
+{
+  double da = *(const double *) a;
+  double db = *(const double *) b;
+  return (da > db) - (da < db);
+}
+
+static void micro_run_case(const MicroCase *micro, MicroData *data, MicroResult *result)
+{
+  double *trial_ns = g_new(double, micro_trials);
+  gint64  begin, elapsed;
+  long    reps = 1L, ops, r;
+  double  sum = 0.0, sum2 = 0.0;
+  int     t;
+
+  /* double the repetitions until a trial lasts long enough */
+  micro->run(data);
+  for (;;)
+    {
+      begin = g_get_monotonic_time();
+      for (r = 0L; r < reps; ++r)
+        {
+          micro->run(data);
+        }
+      elapsed = g_get_monotonic_time() - begin;
+      if (elapsed >= micro_trial_time * G_USEC_PER_SEC || reps >= (1L << 30))
+        {
+          break;
+        }
+      reps *= 2L;
+    }
+
+  for (t = 0; t < micro_trials; ++t)
+    {
+      ops   = 0L;
+      begin = g_get_monotonic_time();
+      for (r = 0L; r < reps; ++r)
+        {
+          ops += micro->run(data);
+        }
+      elapsed     = g_get_monotonic_time() - begin;
+      trial_ns[t] = elapsed * 1.0e3 / ops;
+      sum += trial_ns[t];
+      sum2 += trial_ns[t] * trial_ns[t];
+    }
+  qsort(trial_ns, micro_trials, sizeof(double), micro_compare_double);
+
+  g_strlcpy(result->name, micro->name, sizeof(result->name));
+  g_strlcpy(result->unit, micro->unit, sizeof(result->unit));
+  result->trials    = micro_trials;
+  result->min_ns    = trial_ns[0];
+  result->median_ns = trial_ns[micro_trials / 2];
+  result->mean_ns   = sum / micro_trials;
+  result->stddev_ns = sqrt(SLOPE_MAX(sum2 / micro_trials - result->mean_ns * result->mean_ns, 0.0));
+  g_free(trial_ns);
+}
+
+static gboolean micro_write_json(const char *path, GArray *results)
+{
+  FILE *file = fopen(path, "w");
+  guint k;
+  if (file == NULL)
+    {
+      return FALSE;
+    }
+  /* one result per line, --baseline reads it back that way */
+  fprintf(file, "{\n  \"version\": 1,\n  \"results\": [\n");
+  for (k = 0; k < results->len; ++k)
+    {
+      const MicroResult *result = &g_array_index(results, MicroResult, k);
+      fprintf(file,
+              "    {\"case\": \"%s\", \"unit\": \"%s\", \"trials\": %d, \"min_ns\": %.6f, "
+              "\"median_ns\": %.6f, \"mean_ns\": %.6f, \"stddev_ns\": %.6f}%s\n",
+              result->name,
+              result->unit,
+              result->trials,
+              result->min_ns,
+              result->median_ns,
+              result->mean_ns,
+              result->stddev_ns,
+              (k + 1 < results->len) ? "," : "");
+    }
+  fprintf(file, "  ]\n}\n");
+  return fclose(file) == 0;
+}
+
+static GArray *micro_read_baseline(const char *path)
+{
+  GArray *baseline;
+  char *  contents;
+  char ** lines;
+  int     k;
+  if (!g_file_get_contents(path, &contents, NULL, NULL))
+    {
+      return NULL;
+    }
+  baseline = g_array_new(FALSE, TRUE, sizeof(MicroResult));
+  lines    = g_strsplit(contents, "\n", -1);
+  for (k = 0; lines[k] != NULL; ++k)
+    {
+      MicroResult result;
+      memset(&result, 0, sizeof(MicroResult));
+      if (sscanf(lines[k],
+                 " {\"case\": \"%31[^\"]\", \"unit\": \"%15[^\"]\", \"trials\": %d, "
+                 "\"min_ns\": %lf, \"median_ns\": %lf, \"mean_ns\": %lf, \"stddev_ns\": %lf",
+                 result.name,
+                 result.unit,
+                 &result.trials,
+                 &result.min_ns,
+                 &result.median_ns,
+                 &result.mean_ns,
+                 &result.stddev_ns) == 7)
+        {
+          g_array_append_val(baseline, result);
+        }
+    }
+  g_strfreev(lines);
+  g_free(contents);
+  return baseline;
+}
+
+static int micro_compare(GArray *results, GArray *baseline)
+{
+  int   n_slower = 0;
+  guint k, j;
+
+  g_print("\n%-10s %12s %12s %8s\n", "case", "base median", "median", "change");
+  for (k = 0; k < results->len; ++k)
+    {
+      const MicroResult *result = &g_array_index(results, MicroResult, k);
+      for (j = 0; j < baseline->len; ++j)
+        {
+          const MicroResult *base = &g_array_index(baseline, MicroResult, j);
+          double             change;
+          if (strcmp(base->name, result->name) != 0)
+            {
+              continue;
+            }
+          change = (result->median_ns / base->median_ns - 1.0) * 100.0;
+          g_print("%-10s %12.3f %12.3f %+7.1f%%%s\n",
+                  result->name,
+                  base->median_ns,
+                  result->median_ns,
+                  change,
+                  (change > micro_threshold) ? "  slower" : "");
+          if (change > micro_threshold)
+            {
+              n_slower += 1;
+            }
+          break;
+        }
+    }
+  return n_slower;
+}
+
+static gboolean micro_is_selected(const char *name, char **selected)
+{
+  int k;
+  if (selected == NULL)
+    {
+      return TRUE;
+    }
+  for (k = 0; selected[k] != NULL; ++k)
+    {
+      if (strcmp(selected[k], name) == 0)
+        {
+          return TRUE;
+        }
+    }
+  return FALSE;
+}
+
+int main(int argc, char *argv[])
+{
+  GOptionContext *context;
+  GError *        error = NULL;
+  GArray *        results, *baseline = NULL;
+  MicroData       data;
+  char **         selected = NULL;
+  int             k, status = 0;
+
+  context = g_option_context_new("- time the hot paths of slope one by one");
+  g_option_context_add_main_entries(context, micro_options, NULL);
+  if (!g_option_context_parse(context, &argc, &argv, &error))
+    {
+      g_printerr("slope-microbench: %s\n", error->message);
+      g_error_free(error);
+      g_option_context_free(context);
+      return 2;
+    }
+  g_option_context_free(context);
+  if (micro_trials < 1)
+    {
+      g_printerr("slope-microbench: at least one trial is needed\n");
+      return 2;
+    }
+  if (micro_cases != NULL)
+    {
+      selected = g_strsplit(micro_cases, ",", -1);
+    }
+  if (micro_baseline != NULL)
+    {
+      baseline = micro_read_baseline(micro_baseline);
+      if (baseline == NULL)
+        {
+          g_printerr("slope-microbench: could not read %s\n", micro_baseline);
+          return 2;
+        }
+    }
+  if (micro_cpu >= 0 && !micro_pin_cpu(micro_cpu))
+    {
+      g_printerr("slope-microbench: could not pin to CPU %d, timings will be noisier\n",
+                 micro_cpu);
+    }
+
+  micro_data_init(&data);
+  results = g_array_new(FALSE, TRUE, sizeof(MicroResult));
+  g_print("%-10s %6s %6s %12s %12s %12s %8s\n",
+          "case", "unit", "trials", "min ns", "median ns", "mean ns", "stddev");
+  for (k = 0; micro_case_list[k].name != NULL; ++k)
+    {
+      MicroResult result;
+      if (!micro_is_selected(micro_case_list[k].name, selected))
+        {
+          continue;
+        }
+      micro_run_case(&micro_case_list[k], &data, &result);
+      g_print("%-10s %6s %6d %12.3f %12.3f %12.3f %7.1f%%\n",
+              result.name,
+              result.unit,
+              result.trials,
+              result.min_ns,
+              result.median_ns,
+              result.mean_ns,
+              100.0 * result.stddev_ns / result.mean_ns);
+      g_array_append_val(results, result);
+    }
+
+  if (micro_json != NULL && !micro_write_json(micro_json, results))
+    {
+      g_printerr("slope-microbench: could not write %s\n", micro_json);
+      status = 1;
+    }
+  if (baseline != NULL && micro_compare(results, baseline) > 0)
+    {
+      status = 1;
+    }
+
+  if (baseline != NULL)
+    {
+      g_array_free(baseline, TRUE);
+    }
+  g_array_free(results, TRUE);
+  g_strfreev(selected);
+  micro_data_clear(&data);
+  return status;
+}
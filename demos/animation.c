@@ -33,6 +33,11 @@ static gboolean timer_callback(GtkWidget *chart)
   static long count = 0;
   count++;
 
+  /* skip a step rather than wait for the frame being drawn */
+  if (!slope_figure_try_lock(slope_scale_get_figure(scale)))
+    {
+      return TRUE;
+    }
   long k;
   for (k = 0; k < n; ++k)
     {
@@ -40,6 +45,7 @@ static gboolean timer_callback(GtkWidget *chart)
     }
 
   slope_xyseries_set_data(SLOPE_XYSERIES(series), x, y, n);
+  slope_figure_unlock(slope_scale_get_figure(scale));
   slope_chart_redraw(SLOPE_CHART(chart));
   return TRUE;
 }
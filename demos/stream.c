@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2017,2023  Elvis Teixeira, Anatoliy Sokolov
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <slope/slope.h>
+
+#define CAPACITY 20000
+#define BATCH    1000
+
+SlopeScale * scale;
+SlopeItem *  series;
+GtkWidget *  chart;
+
+static gboolean timer_callback(GtkWidget *chart)
+{
+  static long count = 0;
+  double      x[BATCH], y[BATCH];
+
+  /* append a new batch of samples, the oldest ones are dropped
+   * once the series holds its capacity */
+  long k;
+  for (k = 0; k < BATCH; ++k, ++count)
+    {
+      x[k] = count * 0.001;
+      y[k] = sin(x[k]) + 0.2 * sin(37.0 * x[k]) + 0.05 * g_random_double();
+    }
+
+  slope_streamseries_append(SLOPE_STREAMSERIES(series), x, y, BATCH);
+  slope_chart_redraw(SLOPE_CHART(chart));
+  return TRUE;
+}
+
+static void
+activate (GtkApplication *app,
+          gpointer        user_data)
+{
+  chart = slope_chart_new();
+
+  gtk_application_add_window (app, GTK_WINDOW (chart));
+
+  scale = slope_xyscale_new();
+  slope_chart_add_scale(SLOPE_CHART(chart), scale);
+
+  series = slope_streamseries_new(CAPACITY);
+  slope_item_set_name(series, "Signal");
+  slope_scale_add_item(scale, series);
+
+  g_timeout_add(30, (GSourceFunc) timer_callback, (gpointer) chart);
+
+  gtk_window_present (GTK_WINDOW (chart));
+}
+
+int main(int argc, char *argv[])
+{
+  GtkApplication *app;
+  int status = 0;
+
+  app = gtk_application_new ("slope.stream", G_APPLICATION_DEFAULT_FLAGS);
+  g_signal_connect (app, "activate", G_CALLBACK (activate), NULL);
+  status = g_application_run (G_APPLICATION (app), argc, argv);
+  g_object_unref (app);
+
+  return status;
+}
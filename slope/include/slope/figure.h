@@ -23,6 +23,7 @@
 
 #include <glib-object.h>
 #include <slope/legend.h>
+#include <slope/stats.h>
 
 #define SLOPE_FIGURE_TYPE (slope_figure_get_type())
 #define SLOPE_FIGURE(obj) \
@@ -43,6 +44,13 @@ typedef enum _SlopeFigureFrameMode {
   SLOPE_FIGURE_ROUNDRECTANGLE,
 } SlopeFigureFrameMode;
 
+typedef enum _SlopeFrameFormat {
+  /* a single YUV4MPEG2 stream, 4:2:0 */
+  SLOPE_FRAME_Y4M,
+  /* one complete PNG image per frame, back to back */
+  SLOPE_FRAME_PNG
+} SlopeFrameFormat;
+
 struct _SlopeFigure
 {
   GObject parent;
@@ -87,8 +95,123 @@ void slope_figure_write_to_png(SlopeFigure *self,
                                int          width,
                                int          height);
 
+/* Writes the figure as a PNG through write_func. The figure is
+ * drawn once per horizontal band, clipped to the band's rows, and
+ * the rows are encoded as the bands complete, so peak memory stays
+ * at a few bands whatever the size. A series only visits the runs
+ * of samples whose y range reaches the band, found through its
+ * level of detail pyramid or one built for the first band, so the
+ * bands together walk the data about once. slope_figure_write_to_png()
+ * takes this path for images above 16 megapixels */
+gboolean slope_figure_write_to_png_stream(SlopeFigure *      self,
+                                          cairo_write_func_t write_func,
+                                          void *             closure,
+                                          int                width,
+                                          int                height);
+
+/* Vector exports, width and height are in points (1/72 inch).
+ * Series are decimated to the export resolution, so a line of
+ * millions of samples costs a few segments per dot of the output
+ * width. The _stream variants hand the output to write_func as
+ * cairo produces it */
+gboolean slope_figure_write_to_svg(SlopeFigure *self,
+                                   const char * filename,
+                                   double       width,
+                                   double       height);
+
+gboolean slope_figure_write_to_svg_stream(SlopeFigure *      self,
+                                          cairo_write_func_t write_func,
+                                          void *             closure,
+                                          double             width,
+                                          double             height);
+
+gboolean slope_figure_write_to_pdf(SlopeFigure *self,
+                                   const char * filename,
+                                   double       width,
+                                   double       height);
+
+gboolean slope_figure_write_to_pdf_stream(SlopeFigure *      self,
+                                          cairo_write_func_t write_func,
+                                          void *             closure,
+                                          double             width,
+                                          double             height);
+
+/* Called before each frame of slope_figure_write_frames() to
+ * update the data, returning FALSE ends the sequence */
+typedef gboolean (*SlopeFrameFunc)(SlopeFigure *figure, int frame, gpointer user_data);
+
+/* Renders up to n_frames frames (no limit if negative, until
+ * frame_func stops it) into a single reused image and streams them
+ * through write_func. Between frames only the items the frame
+ * function changed are drawn again, like in a view */
+gboolean slope_figure_write_frames(SlopeFigure *      self,
+                                   SlopeFrameFormat   format,
+                                   int                width,
+                                   int                height,
+                                   double             fps,
+                                   int                n_frames,
+                                   SlopeFrameFunc     frame_func,
+                                   gpointer           user_data,
+                                   cairo_write_func_t write_func,
+                                   void *             closure);
+
+/* Resolution, in dots per inch, the vector exports keep detail
+ * for. 300 by default, zero or less emits every sample */
+void slope_figure_set_export_dpi(SlopeFigure *self, double dpi);
+
+double slope_figure_get_export_dpi(SlopeFigure *self);
+
 SlopeView *slope_figure_get_view(SlopeFigure *self);
 
+/* The rounded frame suits a window, exports always use a plain
+ * rectangle whatever the mode */
+void slope_figure_set_frame_mode(SlopeFigure *self, SlopeFigureFrameMode mode);
+
+SlopeFigureFrameMode slope_figure_get_frame_mode(SlopeFigure *self);
+
+/* With more than one visible scale, draws each of them into an
+ * image of its own on the worker threads and then composites the
+ * images into the target, in the order of the scale list. Only
+ * for raster targets, on by default. Custom scale and item types
+ * must not share mutable state across scales while enabled */
+void slope_figure_set_parallel(SlopeFigure *self, gboolean parallel);
+
+gboolean slope_figure_get_parallel(SlopeFigure *self);
+
+/* Measures the frames drawn from now on: the time of each stage,
+ * scale and item and the work done by the series. Off by default,
+ * when on it costs a clock read per item and stage */
+void slope_figure_set_profiling(SlopeFigure *self, gboolean profiling);
+
+gboolean slope_figure_get_profiling(SlopeFigure *self);
+
+/* Copies the measures of the last complete frame, from any thread.
+ * Returns FALSE while no frame was measured */
+gboolean slope_figure_get_render_stats(SlopeFigure *self, SlopeRenderStats *stats);
+
+/* Shows the measures of the last frame over the top right corner
+ * of the figure, turning profiling on */
+void slope_figure_set_show_stats(SlopeFigure *self, gboolean show);
+
+gboolean slope_figure_get_show_stats(SlopeFigure *self);
+
+/* Views in async mode draw the figure on a worker thread while
+ * holding this lock. The setters of the figure, its scales and
+ * items take it themselves. Called from the main loop's thread
+ * while a frame is being drawn they do not wait, the change is
+ * kept and made once the frame is done, so the getters return
+ * the old values until then. The application must hold the lock
+ * while it writes to sample arrays a series borrows, and around
+ * changes that must be drawn together. The producer interfaces of
+ * the series (push, begin_write and end_write) do not need it */
+void slope_figure_lock(SlopeFigure *self);
+
+/* Takes the lock only if no other thread holds it, so the main
+ * loop's thread can skip an update instead of waiting for a frame */
+gboolean slope_figure_try_lock(SlopeFigure *self);
+
+void slope_figure_unlock(SlopeFigure *self);
+
 SlopeItem *slope_figure_get_legend(SlopeFigure *self);
 
 SLOPE_END_DECLS
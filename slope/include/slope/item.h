@@ -54,10 +54,11 @@ typedef struct _SlopeItemClass
   void (*get_figure_rect) (SlopeItem *self, graphene_rect_t *rect);
   void (*get_data_rect) (SlopeItem *self, graphene_rect_t *rect);
   void (*mouse_event)(SlopeItem *self, SlopeMouseEvent *event);
+  void (*sync)(SlopeItem *self);
 
-  /* Padding to allow adding up to 4 members
+  /* Padding to allow adding up to 3 members
      without breaking ABI. */
-  gpointer padding[4];
+  gpointer padding[3];
 } SlopeItemClass;
 
 GType slope_item_get_type(void) G_GNUC_CONST;
@@ -92,6 +93,15 @@ void slope_item_set_name(SlopeItem *self, const char *name);
 
 void slope_item_detach(SlopeItem *self);
 
+/* Makes views draw the item again instead of reusing the image
+ * kept from the last frame. Needed after changes the item can't
+ * see, like editing its data arrays in place */
+void slope_item_invalidate(SlopeItem *self);
+
+/* Microseconds the item and its subitems took to draw in the last
+ * frame of a profiled figure, zero if its image was reused */
+gint64 slope_item_get_draw_time(SlopeItem *self);
+
 SLOPE_END_DECLS
 
 #endif /* SLOPE_ITEM_H */
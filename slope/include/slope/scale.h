@@ -22,6 +22,7 @@
 #define SLOPE_SCALE_H
 
 #include <slope/legend.h>
+#include <slope/stats.h>
 
 #define SLOPE_SCALE_TYPE (slope_scale_get_type())
 #define SLOPE_SCALE(obj) \
@@ -59,10 +60,17 @@ typedef struct _SlopeScaleClass
   void (*get_data_rect) (SlopeScale *self, graphene_rect_t *rect);
   void (*mouse_event)(SlopeScale *self, SlopeMouseEvent *event);
   void (*position_legend)(SlopeScale *self);
-
-  /* Padding to allow adding up to 4 members
+  void (*map_array) (SlopeScale *      self,
+                     graphene_point_t *res,
+                     const double *    x_vec,
+                     const double *    y_vec,
+                     long              n_pts);
+  /* transient decorations drawn over the retained image every frame */
+  void (*draw_overlay)(SlopeScale *self, const graphene_rect_t *rect, cairo_t *cr);
+
+  /* Padding to allow adding up to 2 members
      without breaking ABI. */
-  gpointer padding[4];
+  gpointer padding[2];
 } SlopeScaleClass;
 
 GType slope_scale_get_type(void) G_GNUC_CONST;
@@ -85,8 +93,31 @@ void slope_scale_unmap (SlopeScale *      self,
                         graphene_point_t *      res,
                         const graphene_point_t *src);
 
+/* Maps n_pts data points given as separate x and y arrays
+ * into res, which must have room for n_pts points */
+void slope_scale_map_array (SlopeScale *      self,
+                            graphene_point_t *res,
+                            const double *    x_vec,
+                            const double *    y_vec,
+                            long              n_pts);
+
+/* Fits the ranges to the data of the items. Like the rescales after
+ * adding, removing or updating items it happens on the next draw, or
+ * when the ranges are used before that */
 void slope_scale_rescale(SlopeScale *self);
 
+/* Between these no rescale happens, which makes building a scale
+ * with many items cheaper. Ranges set inside the batch are replaced
+ * by the rescale it defers. Batches nest */
+void slope_scale_begin_batch(SlopeScale *self);
+
+void slope_scale_end_batch(SlopeScale *self);
+
+/* Views keep rendered images of the scale's decorations and of
+ * each item and only draw them again after a change. This drops all
+ * of them, slope_item_invalidate() drops a single item's image */
+void slope_scale_invalidate(SlopeScale *self);
+
 void slope_scale_get_figure_rect (SlopeScale *self, graphene_rect_t *rect);
 
 void slope_scale_get_data_rect (SlopeScale *self, graphene_rect_t *rect);
@@ -95,6 +126,11 @@ SlopeFigure *slope_scale_get_figure(SlopeScale *self);
 
 SlopeItem *slope_scale_get_legend(SlopeScale *self);
 
+/* The share of the scale in the last frame of a profiled figure,
+ * SLOPE_RENDER_SCALES holding its whole time. Read it between
+ * frames, from the thread drawing the figure */
+void slope_scale_get_render_stats(SlopeScale *self, SlopeRenderStats *stats);
+
 SlopeView *slope_scale_get_view(SlopeScale *self);
 
 gboolean slope_scale_get_is_managed(SlopeScale *self);
@@ -32,6 +32,7 @@
 
 #include <slope/xyaxis.h>
 #include <slope/xyscale.h>
+#include <slope/streamseries.h>
 #include <slope/xyseries.h>
 
 #include <slope/chart.h>
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2017,2023  Elvis Teixeira, Anatoliy Sokolov
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SLOPE_STATS_H
+#define SLOPE_STATS_H
+
+#include <slope/drawing.h>
+
+SLOPE_BEGIN_DECLS
+
+typedef enum _SlopeRenderStage {
+  SLOPE_RENDER_BACKGROUND,
+  /* all the scales, including the next three stages */
+  SLOPE_RENDER_SCALES,
+  SLOPE_RENDER_ITEMS,
+  /* axis lines, ticks and the layout of their labels */
+  SLOPE_RENDER_AXES,
+  /* the legends of the scales and the figure's */
+  SLOPE_RENDER_LEGEND,
+  SLOPE_RENDER_TOTAL,
+  SLOPE_RENDER_N_STAGES
+} SlopeRenderStage;
+
+/* What one frame cost. Times are wall clock microseconds, with
+ * parallel scales the items, axes and legend stages add up the
+ * time of every worker. The counters add up the work of every
+ * series drawn */
+typedef struct _SlopeRenderStats
+{
+  /* frames measured so far, the rest describes the last one */
+  guint64 frame;
+  gint64  stage_time[SLOPE_RENDER_N_STAGES];
+  /* points taken through slope_scale_map_array() */
+  guint64 points;
+  /* line segments sent to cairo */
+  guint64 segments;
+  /* symbols and dots drawn */
+  guint64 markers;
+} SlopeRenderStats;
+
+SLOPE_END_DECLS
+
+#endif /* SLOPE_STATS_H */
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2017,2023  Elvis Teixeira, Anatoliy Sokolov
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SLOPE_STREAMSERIES_H
+#define SLOPE_STREAMSERIES_H
+
+#include <slope/item.h>
+
+#define SLOPE_STREAMSERIES_TYPE (slope_streamseries_get_type())
+#define SLOPE_STREAMSERIES(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj), SLOPE_STREAMSERIES_TYPE, SlopeStreamSeries))
+#define SLOPE_STREAMSERIES_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST((klass), SLOPE_STREAMSERIES_TYPE, SlopeStreamSeriesClass))
+#define SLOPE_IS_STREAMSERIES(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj), SLOPE_STREAMSERIES_TYPE))
+#define SLOPE_IS_STREAMSERIES_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE((klass), SLOPE_STREAMSERIES_TYPE))
+#define SLOPE_STREAMSERIES_GET_CLASS(obj) \
+  (SLOPE_STREAMSERIES_CLASS(G_OBJECT_GET_CLASS(obj)))
+
+SLOPE_BEGIN_DECLS
+
+/* A line series for live data. It owns a fixed capacity ring
+ * buffer: appending past the capacity drops the oldest samples,
+ * and the data bounds are kept up to date incrementally, so the
+ * cost of an append only depends on the number of new samples. */
+typedef struct _SlopeStreamSeries
+{
+  SlopeItem parent;
+
+  /* Padding to allow adding up to 4 members
+     without breaking ABI. */
+  gpointer padding[4];
+} SlopeStreamSeries;
+
+typedef struct _SlopeStreamSeriesClass
+{
+  SlopeItemClass parent_class;
+
+  /* Padding to allow adding up to 4 members
+     without breaking ABI. */
+  gpointer padding[4];
+} SlopeStreamSeriesClass;
+
+GType slope_streamseries_get_type(void) G_GNUC_CONST;
+
+SlopeItem *slope_streamseries_new(long capacity);
+
+void slope_streamseries_append(SlopeStreamSeries *self,
+                               const double *     x_vec,
+                               const double *     y_vec,
+                               long               n_pts);
+
+/* Thread safe version of slope_streamseries_append() for one
+ * producer thread. The samples are queued without locking and
+ * moved into the series by the main thread right before the view
+ * draws, which is also scheduled from here. Returns how many
+ * samples were queued, fewer than n_pts if the queue is full.
+ * The producer must hold its own reference to the series. */
+long slope_streamseries_push(SlopeStreamSeries *self,
+                             const double *     x_vec,
+                             const double *     y_vec,
+                             long               n_pts);
+
+/* Main thread only */
+void slope_streamseries_clear(SlopeStreamSeries *self);
+
+long slope_streamseries_get_n_points(SlopeStreamSeries *self);
+
+long slope_streamseries_get_capacity(SlopeStreamSeries *self);
+
+void slope_streamseries_set_line_color(SlopeStreamSeries *self,
+                                       const GdkRGBA *    color);
+
+void slope_streamseries_set_line_width(SlopeStreamSeries *self,
+                                       double             width);
+
+SLOPE_END_DECLS
+
+#endif /* SLOPE_STREAMSERIES_H */
@@ -64,8 +64,22 @@ GtkWidget *slope_view_new_with_figure(SlopeFigure *figure);
 
 void slope_view_set_figure(SlopeView *self, SlopeFigure *figure);
 
+/* Redraws the whole figure on the next frame, requests made in
+ * between frames are merged into one */
 void slope_view_redraw(SlopeView *self);
 
+/* Number of redraw requests and mouse motion states merged into an
+ * already pending frame since the view was created */
+guint64 slope_view_get_coalesced_redraws(SlopeView *self);
+
+/* In async mode the figure is drawn on a worker thread and the
+ * view keeps showing the last finished frame meanwhile. A frame
+ * made stale by newer data is abandoned. Mouse events wait for
+ * the frame in flight, see slope_figure_lock() */
+void slope_view_set_async(SlopeView *self, gboolean async);
+
+gboolean slope_view_get_async(SlopeView *self);
+
 SlopeFigure *slope_view_get_figure(SlopeFigure *self);
 
 void slope_view_write_to_png(SlopeView * self,
@@ -43,10 +43,24 @@ typedef enum _SlopeXySeriesMode {
   SLOPE_SERIES_SQUARES    = 0x00000004,
   SLOPE_SERIES_AREAUNDER  = 0x00000008,
   SLOPE_SERIES_BIGSYMBOL  = 0x00000010,
+  /* one pixel per point, drawn straight into an image, for clouds
+   * of millions of points */
+  SLOPE_SERIES_POINTS     = 0x00000020,
+  /* like POINTS with the opacity following the log of the number
+   * of points that hit each pixel */
+  SLOPE_SERIES_DENSITY    = 0x00000040,
   SLOPE_SERIES_BIGSQUARES = SLOPE_SERIES_SQUARES | SLOPE_SERIES_BIGSYMBOL,
   SLOPE_SERIES_BIGCIRCLES = SLOPE_SERIES_CIRCLES | SLOPE_SERIES_BIGSYMBOL
 } SlopeXySeriesMode;
 
+/* Element types of the arrays given to slope_xyseries_set_samples() */
+typedef enum _SlopeSampleType {
+  SLOPE_SAMPLE_DOUBLE,
+  SLOPE_SAMPLE_FLOAT,
+  SLOPE_SAMPLE_INT16,
+  SLOPE_SAMPLE_INT32
+} SlopeSampleType;
+
 typedef struct _SlopeXySeries
 {
   SlopeItem parent;
@@ -85,10 +99,78 @@ void slope_xyseries_update_data(SlopeXySeries *self,
                                 const double * y_vec,
                                 long           n_pts);
 
+/* Like slope_xyseries_set_data() for arrays of other types, which
+ * are read as they are, without a copy converted to double. Each
+ * axis may have its own type */
+void slope_xyseries_set_samples(SlopeXySeries * self,
+                                gconstpointer   x_vec,
+                                SlopeSampleType x_type,
+                                gconstpointer   y_vec,
+                                SlopeSampleType y_type,
+                                long            n_pts);
+
+/* The borrowed data, the current one and the one given later,
+ * stands for raw * scale + offset on each axis. Turns raw ADC
+ * counts into volts, for instance. The current data is scanned
+ * again with the new factors, as by slope_xyseries_update() */
+void slope_xyseries_set_calibration(SlopeXySeries *self,
+                                    double         x_scale,
+                                    double         x_offset,
+                                    double         y_scale,
+                                    double         y_offset);
+
 void slope_xyseries_set_style(SlopeXySeries *self, const char *style);
 
+/* Takes in the data given with slope_xyseries_set_data(): its
+ * bounds, whether x is sorted and the level of detail pyramid.
+ * All the samples are scanned again */
 void slope_xyseries_update(SlopeXySeries *self);
 
+/* Like slope_xyseries_update() after the borrowed buffers grew to
+ * n_pts samples, the earlier ones left untouched. Only the new
+ * samples are scanned */
+void slope_xyseries_append(SlopeXySeries *self, long n_pts);
+
+/* When decimation is on, line and area plots send at most the
+ * first, minimum, maximum and last point of each pixel column to
+ * cairo, which keeps huge series fast without losing any spike */
+void slope_xyseries_set_decimate(SlopeXySeries *self, gboolean decimate);
+
+gboolean slope_xyseries_get_decimate(SlopeXySeries *self);
+
+/* A non zero budget (in bytes) makes slope_xyseries_update() build a
+ * min/max level of detail pyramid over the data, used to draw lines
+ * and areas with x sorted touching O(width * log n) samples. After
+ * slope_xyseries_append() only the appended part is processed */
+void slope_xyseries_set_lod_budget(SlopeXySeries *self, gsize budget);
+
+gsize slope_xyseries_get_lod_budget(SlopeXySeries *self);
+
+/* Tells that x never decreases along the data, so drawing only
+ * visits the samples inside the visible x range. This is also
+ * detected by slope_xyseries_update(), the hint saves calling it */
+void slope_xyseries_set_x_sorted(SlopeXySeries *self, gboolean sorted);
+
+gboolean slope_xyseries_get_x_sorted(SlopeXySeries *self);
+
+/* Owned, double buffered data that a worker thread may rewrite
+ * while the main thread draws. begin_write() hands out arrays for
+ * n_pts samples to fill, end_write() computes their bounds and
+ * publishes them atomically, returning the new data epoch. The
+ * series switches to them right before its view draws the next
+ * frame and keeps drawing the previous ones until then. Only one
+ * thread may write at a time. slope_xyseries_set_data() goes back
+ * to borrowed data. */
+gboolean slope_xyseries_begin_write(SlopeXySeries *self,
+                                    long           n_pts,
+                                    double **      x_vec,
+                                    double **      y_vec);
+
+guint slope_xyseries_end_write(SlopeXySeries *self);
+
+/* Epoch of the data being drawn, 0 until owned data is shown */
+guint slope_xyseries_get_epoch(SlopeXySeries *self);
+
 SLOPE_END_DECLS
 
 #endif /* SLOPE_XYSERIES_H */
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2017,2023  Elvis Teixeira, Anatoliy Sokolov
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <slope/decimator_p.h>
+#include <slope/drawing_p.h>
+
+static void _decimator_emit(SlopeDecimator *self, const graphene_point_t *p);
+static void _decimator_flush(SlopeDecimator *self);
+
+void _decimator_begin(SlopeDecimator *self, cairo_t *cr)
+{
+  double dx = _drawing_get_column_width(cr), dy = 0.0;
+  /* one bucket per device pixel, whatever the current transform is */
+  cairo_device_to_user_distance(cr, &dx, &dy);
+  self->cr           = cr;
+  self->column_width = sqrt(dx * dx + dy * dy);
+  if (self->column_width <= 0.0)
+    {
+      self->column_width = 1.0;
+    }
+  self->column     = 0L;
+  self->started    = FALSE;
+  self->seq        = 0L;
+  self->n_segments = 0L;
+}
+
+static void _decimator_emit(SlopeDecimator *self, const graphene_point_t *p)
+{
+  cairo_line_to(self->cr, p->x, p->y);
+  self->n_segments += 1L;
+}
+
+static void _decimator_flush(SlopeDecimator *self)
+{
+  /* the first point of the column was emitted when the column
+     was opened, now close it with the extremes (in the order they
+     appeared) and the last point */
+  if (self->min_seq < self->max_seq)
+    {
+      if (self->min_seq > 0L) _decimator_emit(self, &self->min);
+      _decimator_emit(self, &self->max);
+    }
+  else if (self->max_seq < self->min_seq)
+    {
+      if (self->max_seq > 0L) _decimator_emit(self, &self->max);
+      _decimator_emit(self, &self->min);
+    }
+  if (self->seq > self->min_seq && self->seq > self->max_seq)
+    {
+      _decimator_emit(self, &self->last);
+    }
+}
+
+void _decimator_push(SlopeDecimator *self, const graphene_point_t *p)
+{
+  long column = (long) floor(p->x / self->column_width);
+
+  if (self->started == FALSE)
+    {
+      cairo_move_to(self->cr, p->x, p->y);
+      self->started = TRUE;
+    }
+  else if (column != self->column)
+    {
+      _decimator_flush(self);
+      _decimator_emit(self, p);
+    }
+  else
+    {
+      /* still in the same column, just keep track of its extremes */
+      self->seq += 1L;
+      self->last = *p;
+      if (p->y < self->min.y)
+        {
+          self->min     = *p;
+          self->min_seq = self->seq;
+        }
+      if (p->y > self->max.y)
+        {
+          self->max     = *p;
+          self->max_seq = self->seq;
+        }
+      return;
+    }
+
+  /* p opens a new column */
+  self->column  = column;
+  self->seq     = 0L;
+  self->min_seq = 0L;
+  self->max_seq = 0L;
+  self->min     = *p;
+  self->max     = *p;
+  self->last    = *p;
+}
+
+void _decimator_end(SlopeDecimator *self)
+{
+  if (self->started == TRUE)
+    {
+      _decimator_flush(self);
+    }
+}
+
+/* slope/decimator.c */
@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2017,2023  Elvis Teixeira, Anatoliy Sokolov
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SLOPE_DECIMATOR_P_H
+#define SLOPE_DECIMATOR_P_H
+
+#include <slope/drawing.h>
+
+/* Min/max preserving path builder. Points (already in figure
+ * coordinates) are bucketed by pixel column (a dot of the
+ * resolution for vector exports) and for each column
+ * only the first, minimum, maximum and last points are sent to
+ * cairo, so the path size is bounded by ~4x the plot width while
+ * every spike of the original polyline is still drawn. */
+typedef struct _SlopeDecimator
+{
+  cairo_t *        cr;
+  double           column_width;
+  long             column;
+  gboolean         started;
+  graphene_point_t last;
+  graphene_point_t min;
+  graphene_point_t max;
+  long             min_seq;
+  long             max_seq;
+  long             seq;
+  long             n_segments;
+} SlopeDecimator;
+
+void _decimator_begin(SlopeDecimator *self, cairo_t *cr);
+
+void _decimator_push(SlopeDecimator *self, const graphene_point_t *p);
+
+void _decimator_end(SlopeDecimator *self);
+
+#endif /* SLOPE_DECIMATOR_P_H */
@@ -19,10 +19,15 @@
  */
 
 #include <math.h>
-#include <slope/drawing.h>
+#include <slope/drawing_p.h>
 
 #define __SIMILAR_DOUBLE(x1, x2) ((fabs((x2) - (x1)) < 1e-4) ? TRUE : FALSE)
 
+/* vector surfaces measure in points */
+#define DRAWING_POINTS_PER_INCH 72.0
+
+static const cairo_user_data_key_t drawing_resolution_key;
+
 gboolean slope_similar(double x1, double x2)
 {
   return __SIMILAR_DOUBLE(x1, x2);
@@ -141,4 +146,62 @@ slope_cairo_circle (cairo_t *cr, const graphene_point_t *center, double radius)
   cairo_arc(cr, center->x, center->y, radius, 0.0, 6.28318530717959);
 }
 
+gboolean _drawing_target_is_vector(cairo_t *cr)
+{
+  switch (cairo_surface_get_type(cairo_get_target(cr)))
+    {
+    case CAIRO_SURFACE_TYPE_PDF:
+    case CAIRO_SURFACE_TYPE_PS:
+    case CAIRO_SURFACE_TYPE_SVG:
+    case CAIRO_SURFACE_TYPE_SCRIPT:
+    case CAIRO_SURFACE_TYPE_WIN32_PRINTING:
+      return TRUE;
+    default:
+      return FALSE;
+    }
+}
+
+void _drawing_set_vector_resolution(cairo_surface_t *surface, double dpi)
+{
+  double *value = g_new(double, 1);
+  *value        = dpi;
+  cairo_surface_set_user_data(surface, &drawing_resolution_key, value, g_free);
+}
+
+double _drawing_get_vector_resolution(cairo_t *cr)
+{
+  double *dpi;
+  if (!_drawing_target_is_vector(cr))
+    {
+      return 0.0;
+    }
+  dpi = cairo_surface_get_user_data(cairo_get_target(cr), &drawing_resolution_key);
+  return (dpi != NULL && *dpi > 0.0) ? *dpi : 0.0;
+}
+
+double _drawing_get_column_width(cairo_t *cr)
+{
+  double dpi = _drawing_get_vector_resolution(cr);
+  return (dpi > 0.0) ? DRAWING_POINTS_PER_INCH / dpi : 1.0;
+}
+
+gboolean _drawing_get_pixel_transform(cairo_t *       cr,
+                                      cairo_matrix_t *m,
+                                      double *        device_scale)
+{
+  double dev_sx, dev_sy;
+  cairo_get_matrix(cr, m);
+  if (m->xy != 0.0 || m->yx != 0.0 || m->xx <= 0.0 || m->xx != m->yy)
+    {
+      return FALSE;
+    }
+  cairo_surface_get_device_scale(cairo_get_target(cr), &dev_sx, &dev_sy);
+  if (dev_sx != dev_sy)
+    {
+      return FALSE;
+    }
+  *device_scale = dev_sx;
+  return TRUE;
+}
+
 /* slope/drawing.c */
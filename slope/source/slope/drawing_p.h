@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2017,2023  Elvis Teixeira, Anatoliy Sokolov
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SLOPE_DRAWING_P_H
+#define SLOPE_DRAWING_P_H
+
+#include <slope/drawing.h>
+
+/* TRUE for the surfaces whose output is resolution independent */
+gboolean _drawing_target_is_vector(cairo_t *cr);
+
+/* Succeeds when the user to device transform of cr is a uniform
+ * scale plus a translation, the only case where user space maps
+ * onto whole pixels. Then a user point lands on the pixel
+ * ((p * m->xx) + m->x0) * device_scale. */
+gboolean _drawing_get_pixel_transform(cairo_t *       cr,
+                                      cairo_matrix_t *m,
+                                      double *        device_scale);
+
+/* Resolution, in dots per inch, a vector surface is meant for.
+ * Paths drawn into it are not refined beyond it */
+void _drawing_set_vector_resolution(cairo_surface_t *surface, double dpi);
+
+/* 0.0 unless cr draws into a vector surface given a resolution */
+double _drawing_get_vector_resolution(cairo_t *cr);
+
+/* Width, in device units, of the finest detail worth drawing:
+ * a pixel of raster targets, a dot of the resolution of vector
+ * ones when they have one, one device unit otherwise */
+double _drawing_get_column_width(cairo_t *cr);
+
+#endif /* SLOPE_DRAWING_P_H */
@@ -18,10 +18,28 @@
  * If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <stdio.h>
+#include <string.h>
+#include <cairo/cairo-pdf.h>
+#include <cairo/cairo-svg.h>
+#include <slope/drawing_p.h>
 #include <slope/figure_p.h>
 #include <slope/item_p.h>
+#include <slope/layer_p.h>
+#include <slope/png_p.h>
 #include <slope/scale_p.h>
-#include <slope/view.h>
+#include <slope/view_p.h>
+#include <slope/workers_p.h>
+#include <slope/y4m_p.h>
+
+/* PNG exports bigger than this are rendered in bands */
+#define FIGURE_PNG_BANDED_PIXELS (4096L * 4096L)
+/* pixels in each band of a banded export */
+#define FIGURE_PNG_BAND_PIXELS (1L << 22)
+/* resolution vector exports are decimated for by default */
+#define FIGURE_DEFAULT_EXPORT_DPI 300.0
+/* lines of text in the measures overlay */
+#define FIGURE_STATS_LINES 3
 
 typedef struct _SlopeFigurePrivate
 {
@@ -30,12 +48,59 @@ typedef struct _SlopeFigurePrivate
   GdkRGBA    background_color;
   gboolean   managed;
   gboolean   redraw_requested;
+  gboolean   retained;
+  gboolean   parallel;
+  double     export_dpi;
+  double     render_scale;
+  /* held by whoever draws or changes the figure, see
+     slope_figure_lock() */
+  GRecMutex     lock;
+  int           lock_depth;
+  GCancellable *cancellable;
+  /* setter calls put off while a worker thread held the lock,
+     the queue is guarded by calls_lock */
+  GQueue        calls;
+  GMutex        calls_lock;
+  /* measures of the frame being drawn, and of the last complete
+     one that is read under stats_lock */
+  gboolean         profiling;
+  gboolean         show_stats;
+  SlopeRenderStats frame_stats;
+  SlopeRenderStats stats;
+  GMutex           stats_lock;
   double     layout_rows;
   double     layout_cols;
   int        frame_mode;
   SlopeItem *legend;
 } SlopeFigurePrivate;
 
+/* a setter call waiting for the lock */
+typedef struct _SlopeFigureQueuedCall
+{
+  SlopeFigureCallFunc func;
+  SlopeFigureCall     call;
+  gboolean            copied;
+} SlopeFigureQueuedCall;
+
+/* one visible scale drawn by a worker into its own image */
+typedef struct _SlopeFigureScaleJob
+{
+  SlopeScale *    scale;
+  graphene_rect_t rect;
+  SlopeLayer *    layer;
+  cairo_t *       cr;
+} SlopeFigureScaleJob;
+
+/* a band of rows of a PNG export, drawn on the calling thread and
+   converted by a worker */
+typedef struct _SlopeFigurePngBand
+{
+  int              y;
+  int              height;
+  cairo_surface_t *image;
+  unsigned char *  rows;
+} SlopeFigurePngBand;
+
 G_DEFINE_TYPE_WITH_CODE (SlopeFigure, slope_figure, G_TYPE_OBJECT, G_ADD_PRIVATE (SlopeFigure))
 
 static void _figure_update_layout(SlopeFigure *self);
@@ -53,9 +118,32 @@ static void _figure_draw_background(SlopeFigure *    self,
 static void _figure_draw_scales(SlopeFigure *    self,
                                 const graphene_rect_t *rect,
                                 cairo_t *        cr);
+static gboolean _figure_draw_scales_parallel(SlopeFigure *        self,
+                                             SlopeFigureScaleJob *jobs,
+                                             guint                n_jobs,
+                                             cairo_t *            cr);
+static void _figure_draw_scale_job(gpointer job, gpointer user_data);
 static void _figure_draw_legend(SlopeFigure *    self,
                                 const graphene_rect_t *rect,
                                 cairo_t *        cr);
+static void _figure_draw_export(SlopeFigure *self, double width, double height, cairo_t *cr);
+static gint64 _figure_stage_begin(SlopeFigure *self);
+static void _figure_stage_end(SlopeFigure *self, SlopeRenderStage stage, gint64 begin);
+static void _figure_add_scale_stats(SlopeFigure *self, SlopeScale *scale);
+static void _figure_draw_stats(SlopeFigure *           self,
+                               const graphene_rect_t *rect,
+                               cairo_t *              cr);
+static gboolean _figure_write_vector(SlopeFigure *    self,
+                                     cairo_surface_t *surface,
+                                     double           width,
+                                     double           height);
+static void _figure_png_band_job(gpointer band, gpointer user_data);
+static void _figure_run_calls(SlopeFigure *self);
+static gboolean _figure_run_calls_idle(gpointer self);
+static void _figure_queued_call_free(gpointer data);
+static cairo_status_t _figure_write_file(void *               file,
+                                         const unsigned char *data,
+                                         unsigned int         length);
 
 static void slope_figure_class_init(SlopeFigureClass *klass)
 {
@@ -73,6 +161,20 @@ static void slope_figure_init(SlopeFigure *self)
   gdk_rgba_parse (&priv->background_color, "white");
   priv->managed            = TRUE;
   priv->redraw_requested   = FALSE;
+  priv->retained           = FALSE;
+  priv->parallel           = TRUE;
+  priv->export_dpi         = FIGURE_DEFAULT_EXPORT_DPI;
+  priv->render_scale       = 1.0;
+  g_rec_mutex_init(&priv->lock);
+  priv->lock_depth         = 0;
+  priv->cancellable        = NULL;
+  g_queue_init(&priv->calls);
+  g_mutex_init(&priv->calls_lock);
+  priv->profiling          = FALSE;
+  priv->show_stats         = FALSE;
+  memset(&priv->frame_stats, 0, sizeof(SlopeRenderStats));
+  memset(&priv->stats, 0, sizeof(SlopeRenderStats));
+  g_mutex_init(&priv->stats_lock);
   priv->frame_mode         = SLOPE_FIGURE_ROUNDRECTANGLE;
   priv->legend             = slope_legend_new (GTK_ORIENTATION_HORIZONTAL);
   slope_item_set_is_visible(SLOPE_ITEM(priv->legend), FALSE);
@@ -87,6 +189,11 @@ static void _figure_finalize(GObject *self)
       priv->scale_list = NULL;
     }
   g_object_unref(G_OBJECT(priv->legend));
+  /* nothing is left to apply them to */
+  g_queue_clear_full(&priv->calls, _figure_queued_call_free);
+  g_mutex_clear(&priv->calls_lock);
+  g_rec_mutex_clear(&priv->lock);
+  g_mutex_clear(&priv->stats_lock);
   G_OBJECT_CLASS(slope_figure_parent_class)->finalize(self);
 }
 
@@ -113,7 +220,14 @@ static void _figure_draw(SlopeFigure *    self,
                          const graphene_rect_t *in_rect,
                          cairo_t *        cr)
 {
+  SlopeFigurePrivate *priv = slope_figure_get_instance_private (self);
   graphene_rect_t rect;
+  gint64          frame_begin, begin;
+  frame_begin = _figure_stage_begin(self);
+  memset(priv->frame_stats.stage_time, 0, sizeof(priv->frame_stats.stage_time));
+  priv->frame_stats.points   = 0;
+  priv->frame_stats.segments = 0;
+  priv->frame_stats.markers  = 0;
   /* save cr's state and clip tho the figure's rectangle,
      fill the background if required */
   cairo_save(cr);
@@ -122,14 +236,63 @@ static void _figure_draw(SlopeFigure *    self,
       cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
   cairo_set_font_size(cr, 11);
   _figure_add_rect_path(self, &rect, in_rect, cr);
+  begin = _figure_stage_begin(self);
   _figure_draw_background(self, &rect, cr);
+  _figure_stage_end(self, SLOPE_RENDER_BACKGROUND, begin);
   cairo_clip(cr);
+  begin = _figure_stage_begin(self);
   _figure_draw_scales(self, &rect, cr);
+  _figure_stage_end(self, SLOPE_RENDER_SCALES, begin);
+  begin = _figure_stage_begin(self);
   _figure_draw_legend(self, &rect, cr);
+  _figure_stage_end(self, SLOPE_RENDER_LEGEND, begin);
+  /* a cancelled frame is not worth reporting */
+  if (priv->profiling && !_figure_is_cancelled(self))
+    {
+      _figure_stage_end(self, SLOPE_RENDER_TOTAL, frame_begin);
+      priv->frame_stats.frame += 1;
+      g_mutex_lock(&priv->stats_lock);
+      priv->stats = priv->frame_stats;
+      g_mutex_unlock(&priv->stats_lock);
+    }
+  if (priv->show_stats)
+    {
+      _figure_draw_stats(self, &rect, cr);
+    }
   /* give back cr in the same state as we received it */
   cairo_restore(cr);
 }
 
+static gint64 _figure_stage_begin(SlopeFigure *self)
+{
+  SlopeFigurePrivate *priv = slope_figure_get_instance_private (self);
+  return priv->profiling ? g_get_monotonic_time() : 0;
+}
+
+static void _figure_stage_end(SlopeFigure *self, SlopeRenderStage stage, gint64 begin)
+{
+  SlopeFigurePrivate *priv = slope_figure_get_instance_private (self);
+  if (priv->profiling)
+    {
+      priv->frame_stats.stage_time[stage] += g_get_monotonic_time() - begin;
+    }
+}
+
+static void _figure_add_scale_stats(SlopeFigure *self, SlopeScale *scale)
+{
+  SlopeFigurePrivate *priv = slope_figure_get_instance_private (self);
+  SlopeRenderStats    stats;
+  slope_scale_get_render_stats(scale, &stats);
+  /* the scales stage itself is measured around all of them, it
+     is shorter than their sum when they are drawn in parallel */
+  priv->frame_stats.stage_time[SLOPE_RENDER_ITEMS] += stats.stage_time[SLOPE_RENDER_ITEMS];
+  priv->frame_stats.stage_time[SLOPE_RENDER_AXES] += stats.stage_time[SLOPE_RENDER_AXES];
+  priv->frame_stats.stage_time[SLOPE_RENDER_LEGEND] += stats.stage_time[SLOPE_RENDER_LEGEND];
+  priv->frame_stats.points += stats.points;
+  priv->frame_stats.segments += stats.segments;
+  priv->frame_stats.markers += stats.markers;
+}
+
 static void _figure_add_rect_path(SlopeFigure *    self,
                                   graphene_rect_t *rect,
                                   const graphene_rect_t *in_rect,
@@ -172,22 +335,97 @@ static void _figure_draw_scales(SlopeFigure *    self,
   double layout_cell_width  = graphene_rect_get_width (rect) / priv->layout_cols;
   double layout_cell_height = graphene_rect_get_height (rect) / priv->layout_rows;
   GList *             scale_iter         = priv->scale_list;
+  SlopeFigureScaleJob *jobs;
+  guint                n_jobs = 0;
+  guint                k;
+
+  jobs = g_new(SlopeFigureScaleJob, g_list_length(priv->scale_list) + 1);
   while (scale_iter != NULL)
     {
       SlopeScale *scale = SLOPE_SCALE(scale_iter->data);
+      /* here, before the scales may be drawn by other threads */
+      _scale_update(scale);
       if (slope_scale_get_is_visible(scale) == TRUE)
         {
-          graphene_rect_t layout;
+          SlopeFigureScaleJob *job = &jobs[n_jobs++];
 
-          slope_scale_get_layout_rect (scale, &layout);
+          slope_scale_get_layout_rect (scale, &job->rect);
 
-          graphene_rect_scale (&layout, layout_cell_width, layout_cell_height, &layout);
-          graphene_rect_offset (&layout, graphene_rect_get_x (rect), graphene_rect_get_y (rect));
+          graphene_rect_scale (&job->rect, layout_cell_width, layout_cell_height, &job->rect);
+          graphene_rect_offset (&job->rect, graphene_rect_get_x (rect), graphene_rect_get_y (rect));
 
-          _scale_draw (scale, &layout, cr);
+          job->scale = scale;
+          job->layer = NULL;
+          job->cr    = NULL;
         }
       scale_iter = scale_iter->next;
     }
+
+  if (!(priv->parallel && n_jobs > 1
+        && _figure_draw_scales_parallel(self, jobs, n_jobs, cr)))
+    {
+      for (k = 0; k < n_jobs && !_figure_is_cancelled(self); ++k)
+        {
+          _scale_draw (jobs[k].scale, &jobs[k].rect, cr);
+        }
+    }
+  for (k = 0; k < n_jobs && priv->profiling; ++k)
+    {
+      _figure_add_scale_stats(self, jobs[k].scale);
+    }
+  g_free(jobs);
+}
+
+static gboolean _figure_draw_scales_parallel(SlopeFigure *        self,
+                                             SlopeFigureScaleJob *jobs,
+                                             guint                n_jobs,
+                                             cairo_t *            cr)
+{
+  SlopeFigurePrivate *priv = slope_figure_get_instance_private (self);
+  double              render_scale = priv->render_scale;
+  gboolean            ok           = TRUE;
+  guint               k;
+
+  /* each scale gets an image of its own at the pixel density of
+     cr, vector targets are drawn in sequence as before */
+  for (k = 0; k < n_jobs && ok; ++k)
+    {
+      jobs[k].layer = _scale_get_image_layer(jobs[k].scale);
+      ok = _layer_prepare(jobs[k].layer, cr, &jobs[k].rect, render_scale)
+           && (jobs[k].cr = _layer_begin(jobs[k].layer, cr)) != NULL;
+    }
+  if (ok)
+    {
+      /* the images already carry the pixel density, the layers
+         of the scales must not apply it a second time */
+      priv->render_scale = 1.0;
+      _workers_run(_figure_draw_scale_job, jobs, sizeof(SlopeFigureScaleJob), n_jobs, NULL);
+      priv->render_scale = render_scale;
+    }
+  /* composite in list order, so overlapping scales stack the same
+     way they do when drawn in sequence */
+  for (k = 0; k < n_jobs && jobs[k].layer != NULL; ++k)
+    {
+      if (jobs[k].cr != NULL)
+        {
+          _layer_end(jobs[k].layer, jobs[k].cr);
+          if (ok)
+            {
+              _layer_composite(jobs[k].layer, cr);
+            }
+        }
+    }
+  return ok;
+}
+
+static void _figure_draw_scale_job(gpointer data, gpointer user_data)
+{
+  SlopeFigureScaleJob *job = data;
+  SLOPE_UNUSED(user_data);
+  if (!_figure_is_cancelled(slope_scale_get_figure(job->scale)))
+    {
+      _scale_draw(job->scale, &job->rect, job->cr);
+    }
 }
 
 static void _figure_draw_legend(SlopeFigure *    self,
@@ -220,6 +458,59 @@ static void _figure_draw_legend(SlopeFigure *    self,
     }
 }
 
+static void _figure_draw_stats(SlopeFigure *           self,
+                               const graphene_rect_t *rect,
+                               cairo_t *              cr)
+{
+  SlopeRenderStats     stats;
+  cairo_text_extents_t txt_ext;
+  char                 lines[FIGURE_STATS_LINES][128];
+  double               line_height = 13.0;
+  double               width       = 0.0;
+  double               x, y;
+  int                  k;
+  if (!slope_figure_get_render_stats(self, &stats))
+    {
+      return;
+    }
+  g_snprintf(lines[0], sizeof(lines[0]),
+             "frame %" G_GUINT64_FORMAT "  %.2f ms",
+             stats.frame, stats.stage_time[SLOPE_RENDER_TOTAL] * 1.0e-3);
+  g_snprintf(lines[1], sizeof(lines[1]),
+             "bg %.2f  scales %.2f  items %.2f  axes %.2f  legend %.2f",
+             stats.stage_time[SLOPE_RENDER_BACKGROUND] * 1.0e-3,
+             stats.stage_time[SLOPE_RENDER_SCALES] * 1.0e-3,
+             stats.stage_time[SLOPE_RENDER_ITEMS] * 1.0e-3,
+             stats.stage_time[SLOPE_RENDER_AXES] * 1.0e-3,
+             stats.stage_time[SLOPE_RENDER_LEGEND] * 1.0e-3);
+  g_snprintf(lines[2], sizeof(lines[2]),
+             "%" G_GUINT64_FORMAT " points  %" G_GUINT64_FORMAT
+             " segments  %" G_GUINT64_FORMAT " markers",
+             stats.points, stats.segments, stats.markers);
+
+  cairo_save(cr);
+  cairo_select_font_face(
+      cr, "Monospace", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+  cairo_set_font_size(cr, 10);
+  for (k = 0; k < FIGURE_STATS_LINES; ++k)
+    {
+      cairo_text_extents(cr, lines[k], &txt_ext);
+      width = SLOPE_MAX(width, txt_ext.x_advance);
+    }
+  x = graphene_rect_get_x (rect) + graphene_rect_get_width (rect) - width - 12.0;
+  y = graphene_rect_get_y (rect) + 6.0;
+  cairo_new_path(cr);
+  cairo_rectangle(cr, x - 6.0, y, width + 12.0, FIGURE_STATS_LINES * line_height + 8.0);
+  cairo_set_source_rgba(cr, 0.0, 0.0, 0.0, 0.6);
+  cairo_fill(cr);
+  cairo_set_source_rgba(cr, 1.0, 1.0, 1.0, 1.0);
+  for (k = 0; k < FIGURE_STATS_LINES; ++k)
+    {
+      slope_cairo_text(cr, x, y + 1.0 + (k + 1) * line_height, lines[k]);
+    }
+  cairo_restore(cr);
+}
+
 static void _figure_clear_scale_list(gpointer data)
 {
   if (slope_scale_get_is_managed(SLOPE_SCALE(data)) == TRUE)
@@ -242,31 +533,350 @@ void _figure_set_view(SlopeFigure *self, SlopeView *view)
     }
 }
 
+static void _figure_draw_export(SlopeFigure *self, double width, double height, cairo_t *cr)
+{
+  SlopeFigurePrivate *priv = slope_figure_get_instance_private (self);
+  int                 mode_back;
+  slope_figure_lock(self);
+  mode_back        = priv->frame_mode;
+  priv->frame_mode = SLOPE_FIGURE_RECTANGLE;
+  slope_figure_draw(self, &GRAPHENE_RECT_INIT (0.0, 0.0, width, height), cr);
+  priv->frame_mode = mode_back;
+  slope_figure_unlock(self);
+}
+
 void slope_figure_write_to_png(SlopeFigure *self,
                                const char * filename,
                                int          width,
                                int          height)
 {
-  SlopeFigurePrivate *priv;
   cairo_surface_t *   image;
   cairo_t *           cr;
-  int                 mode_back;
+  FILE *              file;
   if (filename == NULL || width <= 0 || height <= 0)
     {
       return;
     }
-  priv = slope_figure_get_instance_private (self);
+  if ((long) width * height > FIGURE_PNG_BANDED_PIXELS)
+    {
+      /* never hold the whole image in memory */
+      file = fopen(filename, "wb");
+      if (file != NULL)
+        {
+          slope_figure_write_to_png_stream(self, _figure_write_file, file, width, height);
+          fclose(file);
+        }
+      return;
+    }
   image       = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
   cr          = cairo_create(image);
-  mode_back   = priv->frame_mode;
-  priv->frame_mode = SLOPE_FIGURE_RECTANGLE;
-  slope_figure_draw(self, &GRAPHENE_RECT_INIT (0.0, 0.0, width, height), cr);
+  _figure_draw_export(self, width, height, cr);
   cairo_surface_write_to_png(image, filename);
-  priv->frame_mode = mode_back;
   cairo_surface_destroy(image);
   cairo_destroy(cr);
 }
 
+static cairo_status_t _figure_write_file(void *               file,
+                                         const unsigned char *data,
+                                         unsigned int         length)
+{
+  if (fwrite(data, 1, length, file) != length)
+    {
+      return CAIRO_STATUS_WRITE_ERROR;
+    }
+  return CAIRO_STATUS_SUCCESS;
+}
+
+gboolean slope_figure_write_to_png_stream(SlopeFigure *      self,
+                                          cairo_write_func_t write_func,
+                                          void *             closure,
+                                          int                width,
+                                          int                height)
+{
+  SlopeFigurePrivate *priv = slope_figure_get_instance_private (self);
+  SlopePngWriter *    writer;
+  SlopeFigurePngBand *bands;
+  cairo_status_t      status = CAIRO_STATUS_SUCCESS;
+  cairo_t *           cr;
+  gboolean            parallel_back;
+  guint               n_bands, k, j;
+  int                 band_height, y;
+
+  if (write_func == NULL || width <= 0 || height <= 0)
+    {
+      return FALSE;
+    }
+  writer = _png_writer_new(write_func, closure, width, height);
+
+  /* each band is drawn straight from the figure, clipped to its
+     rows, so only n_bands bands are alive at any time. The draws
+     share the figure and run in sequence on this thread (the
+     series cull their samples to the band's rows), the
+     conversion to PNG rows runs on the workers. Scale images
+     would have the size of the whole export, so the scales are
+     drawn in sequence too */
+  band_height = (int) SLOPE_MAX(1L, SLOPE_MIN((long) height, FIGURE_PNG_BAND_PIXELS / width));
+  n_bands     = _workers_get_n_threads();
+  bands       = g_new(SlopeFigurePngBand, n_bands);
+  y           = 0;
+  slope_figure_lock(self);
+  parallel_back  = priv->parallel;
+  priv->parallel = FALSE;
+  while (y < height && status == CAIRO_STATUS_SUCCESS)
+    {
+      for (k = 0; k < n_bands && y < height; ++k)
+        {
+          bands[k].y      = y;
+          bands[k].height = SLOPE_MIN(band_height, height - y);
+          bands[k].rows   = NULL;
+          bands[k].image  = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, bands[k].height);
+          y += bands[k].height;
+          if (cairo_surface_status(bands[k].image) != CAIRO_STATUS_SUCCESS)
+            {
+              continue;
+            }
+          cr = cairo_create(bands[k].image);
+          cairo_translate(cr, 0.0, -bands[k].y);
+          cairo_rectangle(cr, 0.0, bands[k].y, width, bands[k].height);
+          cairo_clip(cr);
+          _figure_draw_export(self, width, height, cr);
+          cairo_destroy(cr);
+        }
+      _workers_run(_figure_png_band_job, bands, sizeof(SlopeFigurePngBand), k, writer);
+      /* the encoder takes the rows in order */
+      for (j = 0; j < k; ++j)
+        {
+          if (bands[j].rows == NULL)
+            {
+              status = CAIRO_STATUS_NO_MEMORY;
+            }
+          else if (status == CAIRO_STATUS_SUCCESS)
+            {
+              status = _png_writer_write_rows(writer, bands[j].rows, bands[j].height);
+            }
+          g_free(bands[j].rows);
+        }
+    }
+  priv->parallel = parallel_back;
+  slope_figure_unlock(self);
+  g_free(bands);
+  if (status == CAIRO_STATUS_SUCCESS)
+    {
+      status = _png_writer_finish(writer);
+    }
+  else
+    {
+      _png_writer_finish(writer);
+    }
+  return status == CAIRO_STATUS_SUCCESS;
+}
+
+static gboolean _figure_write_vector(SlopeFigure *    self,
+                                     cairo_surface_t *surface,
+                                     double           width,
+                                     double           height)
+{
+  SlopeFigurePrivate *priv = slope_figure_get_instance_private (self);
+  cairo_status_t      status;
+  cairo_t *           cr;
+
+  if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS)
+    {
+      cairo_surface_destroy(surface);
+      return FALSE;
+    }
+  /* the series leave out the detail finer than the export
+     resolution instead of emitting every sample */
+  _drawing_set_vector_resolution(surface, priv->export_dpi);
+  cr = cairo_create(surface);
+  _figure_draw_export(self, width, height, cr);
+  cairo_show_page(cr);
+  status = cairo_status(cr);
+  cairo_destroy(cr);
+  /* the surface writes out whatever it still holds */
+  cairo_surface_finish(surface);
+  if (status == CAIRO_STATUS_SUCCESS)
+    {
+      status = cairo_surface_status(surface);
+    }
+  cairo_surface_destroy(surface);
+  return status == CAIRO_STATUS_SUCCESS;
+}
+
+gboolean slope_figure_write_to_svg(SlopeFigure *self,
+                                   const char * filename,
+                                   double       width,
+                                   double       height)
+{
+  if (filename == NULL || width <= 0.0 || height <= 0.0)
+    {
+      return FALSE;
+    }
+  return _figure_write_vector(
+      self, cairo_svg_surface_create(filename, width, height), width, height);
+}
+
+gboolean slope_figure_write_to_svg_stream(SlopeFigure *      self,
+                                          cairo_write_func_t write_func,
+                                          void *             closure,
+                                          double             width,
+                                          double             height)
+{
+  if (write_func == NULL || width <= 0.0 || height <= 0.0)
+    {
+      return FALSE;
+    }
+  return _figure_write_vector(
+      self,
+      cairo_svg_surface_create_for_stream(write_func, closure, width, height),
+      width, height);
+}
+
+gboolean slope_figure_write_to_pdf(SlopeFigure *self,
+                                   const char * filename,
+                                   double       width,
+                                   double       height)
+{
+  if (filename == NULL || width <= 0.0 || height <= 0.0)
+    {
+      return FALSE;
+    }
+  return _figure_write_vector(
+      self, cairo_pdf_surface_create(filename, width, height), width, height);
+}
+
+gboolean slope_figure_write_to_pdf_stream(SlopeFigure *      self,
+                                          cairo_write_func_t write_func,
+                                          void *             closure,
+                                          double             width,
+                                          double             height)
+{
+  if (write_func == NULL || width <= 0.0 || height <= 0.0)
+    {
+      return FALSE;
+    }
+  return _figure_write_vector(
+      self,
+      cairo_pdf_surface_create_for_stream(write_func, closure, width, height),
+      width, height);
+}
+
+gboolean slope_figure_write_frames(SlopeFigure *      self,
+                                   SlopeFrameFormat   format,
+                                   int                width,
+                                   int                height,
+                                   double             fps,
+                                   int                n_frames,
+                                   SlopeFrameFunc     frame_func,
+                                   gpointer           user_data,
+                                   cairo_write_func_t write_func,
+                                   void *             closure)
+{
+  SlopeY4mWriter * y4m    = NULL;
+  cairo_status_t   status = CAIRO_STATUS_SUCCESS;
+  cairo_surface_t *image;
+  cairo_t *        cr;
+  int              frame;
+
+  if (write_func == NULL || width <= 0 || height <= 0
+      || (n_frames < 0 && frame_func == NULL))
+    {
+      return FALSE;
+    }
+  /* one surface for the whole sequence */
+  image = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+  if (cairo_surface_status(image) != CAIRO_STATUS_SUCCESS)
+    {
+      cairo_surface_destroy(image);
+      return FALSE;
+    }
+  cr = cairo_create(image);
+  if (format == SLOPE_FRAME_Y4M)
+    {
+      y4m = _y4m_writer_new(write_func, closure, width, height, fps);
+    }
+
+  for (frame = 0; (n_frames < 0 || frame < n_frames) && status == CAIRO_STATUS_SUCCESS; ++frame)
+    {
+      if (frame_func != NULL && !frame_func(self, frame, user_data))
+        {
+          break;
+        }
+      cairo_save(cr);
+      cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
+      cairo_paint(cr);
+      cairo_restore(cr);
+      /* drawn like a view does, what the frame function left
+         untouched comes from the layers of the previous frame */
+      slope_figure_lock(self);
+      _figure_sync(self);
+      _figure_set_retained(self, TRUE, 1.0);
+      _figure_draw_export(self, width, height, cr);
+      _figure_set_retained(self, FALSE, 1.0);
+      slope_figure_unlock(self);
+      if (y4m != NULL)
+        {
+          status = _y4m_writer_write_frame(y4m, image);
+        }
+      else
+        {
+          status = cairo_surface_write_to_png_stream(image, write_func, closure);
+        }
+    }
+
+  if (y4m != NULL)
+    {
+      cairo_status_t finish_status = _y4m_writer_finish(y4m);
+      if (status == CAIRO_STATUS_SUCCESS)
+        {
+          status = finish_status;
+        }
+    }
+  cairo_destroy(cr);
+  cairo_surface_destroy(image);
+  return status == CAIRO_STATUS_SUCCESS;
+}
+
+static void _figure_set_export_dpi_call(const SlopeFigureCall *call)
+{
+  slope_figure_set_export_dpi(call->object, call->d[0]);
+}
+
+void slope_figure_set_export_dpi(SlopeFigure *self, double dpi)
+{
+  SlopeFigurePrivate *priv = slope_figure_get_instance_private (self);
+  SlopeFigureCall     call = {.object = self, .d = {dpi}};
+  if (_figure_begin_change(self, _figure_set_export_dpi_call, &call))
+    {
+      priv->export_dpi = dpi;
+      _figure_end_change(self);
+    }
+}
+
+double slope_figure_get_export_dpi(SlopeFigure *self)
+{
+  SlopeFigurePrivate *priv = slope_figure_get_instance_private (self);
+  return priv->export_dpi;
+}
+
+static void _figure_png_band_job(gpointer data, gpointer user_data)
+{
+  SlopeFigurePngBand *band   = data;
+  SlopePngWriter *    writer = user_data;
+
+  if (cairo_surface_status(band->image) == CAIRO_STATUS_SUCCESS)
+    {
+      cairo_surface_flush(band->image);
+      band->rows = g_malloc(_png_writer_get_rows_size(writer, band->height));
+      _png_writer_convert_rows(writer,
+                               cairo_image_surface_get_data(band->image),
+                               cairo_image_surface_get_stride(band->image),
+                               band->height,
+                               band->rows);
+    }
+  cairo_surface_destroy(band->image);
+}
+
 static void _figure_update_layout(SlopeFigure *self)
 {
   SlopeFigurePrivate *priv = slope_figure_get_instance_private (self);
@@ -302,11 +912,309 @@ void _figure_handle_mouse_event(SlopeFigure *self, SlopeMouseEvent *event)
     }
   if (priv->redraw_requested == TRUE)
     {
-      slope_view_redraw(priv->view);
+      /* interaction invalidates the scales it changes by itself,
+         the rest of the figure can be composited from the cache */
+      _view_queue_frame(priv->view);
       priv->redraw_requested = FALSE;
     }
 }
 
+void _figure_sync(SlopeFigure *self)
+{
+  SlopeFigurePrivate *priv = slope_figure_get_instance_private (self);
+  GList *iter;
+  for (iter = priv->scale_list; iter != NULL; iter = iter->next)
+    {
+      _scale_sync(SLOPE_SCALE(iter->data));
+    }
+}
+
+void _figure_set_retained(SlopeFigure *self, gboolean retained, double render_scale)
+{
+  SlopeFigurePrivate *priv = slope_figure_get_instance_private (self);
+  priv->retained     = retained;
+  priv->render_scale = (render_scale > 0.0) ? render_scale : 1.0;
+}
+
+gboolean _figure_get_retained(SlopeFigure *self, double *render_scale)
+{
+  SlopeFigurePrivate *priv = slope_figure_get_instance_private (self);
+  if (render_scale != NULL)
+    {
+      *render_scale = priv->render_scale;
+    }
+  return priv->retained;
+}
+
+void slope_figure_lock(SlopeFigure *self)
+{
+  SlopeFigurePrivate *priv = slope_figure_get_instance_private (self);
+  g_rec_mutex_lock(&priv->lock);
+  priv->lock_depth++;
+}
+
+gboolean slope_figure_try_lock(SlopeFigure *self)
+{
+  SlopeFigurePrivate *priv = slope_figure_get_instance_private (self);
+  if (!g_rec_mutex_trylock(&priv->lock))
+    {
+      return FALSE;
+    }
+  priv->lock_depth++;
+  return TRUE;
+}
+
+void slope_figure_unlock(SlopeFigure *self)
+{
+  SlopeFigurePrivate *priv    = slope_figure_get_instance_private (self);
+  gboolean            on_main = g_main_context_is_owner(g_main_context_default());
+  gboolean            last    = (priv->lock_depth == 1);
+  gboolean            waiting;
+
+  if (last && on_main)
+    {
+      /* the changes put off meanwhile go in before anyone else
+         can take the lock */
+      _figure_run_calls(self);
+    }
+  priv->lock_depth--;
+  g_rec_mutex_unlock(&priv->lock);
+  if (last && !on_main)
+    {
+      /* checked after unlocking, a call queued before that is
+         either seen here or made by the thread that queued it */
+      g_mutex_lock(&priv->calls_lock);
+      waiting = !g_queue_is_empty(&priv->calls);
+      g_mutex_unlock(&priv->calls_lock);
+      if (waiting)
+        {
+          g_idle_add_full(G_PRIORITY_DEFAULT, _figure_run_calls_idle,
+                          g_object_ref(self), g_object_unref);
+        }
+    }
+}
+
+gboolean _figure_begin_change(SlopeFigure *          figure,
+                              SlopeFigureCallFunc    func,
+                              const SlopeFigureCall *call)
+{
+  SlopeFigurePrivate *   priv;
+  SlopeFigureQueuedCall *queued;
+
+  if (figure == NULL)
+    {
+      return TRUE;
+    }
+  if (!g_main_context_is_owner(g_main_context_default()))
+    {
+      slope_figure_lock(figure);
+      return TRUE;
+    }
+  priv = slope_figure_get_instance_private (figure);
+  if (slope_figure_try_lock(figure))
+    {
+      if (priv->lock_depth == 1)
+        {
+          /* keep the order the setters were called in */
+          _figure_run_calls(figure);
+        }
+      return TRUE;
+    }
+  /* a worker is drawing, the main thread must not wait for it */
+  queued         = g_new(SlopeFigureQueuedCall, 1);
+  queued->func   = func;
+  queued->call   = *call;
+  queued->copied = (call->p_size > 0);
+  g_object_ref(call->object);
+  if (call->keep != NULL)
+    {
+      g_object_ref(call->keep);
+    }
+  if (queued->copied)
+    {
+      queued->call.p[0] = (call->p[0] != NULL) ? g_memdup2(call->p[0], call->p_size) : NULL;
+      queued->call.p[1] = (call->p[1] != NULL) ? g_memdup2(call->p[1], call->p_size) : NULL;
+    }
+  g_mutex_lock(&priv->calls_lock);
+  g_queue_push_tail(&priv->calls, queued);
+  g_mutex_unlock(&priv->calls_lock);
+  /* the worker may have let go since, then nobody else would
+     make the call soon */
+  if (slope_figure_try_lock(figure))
+    {
+      slope_figure_unlock(figure);
+    }
+  return FALSE;
+}
+
+void _figure_end_change(SlopeFigure *figure)
+{
+  if (figure != NULL)
+    {
+      slope_figure_unlock(figure);
+    }
+}
+
+SlopeFigure *_figure_of_scale(SlopeScale *scale)
+{
+  return (scale != NULL) ? slope_scale_get_figure(scale) : NULL;
+}
+
+static void _figure_run_calls(SlopeFigure *self)
+{
+  SlopeFigurePrivate *   priv = slope_figure_get_instance_private (self);
+  SlopeFigureQueuedCall *queued;
+
+  /* one at a time, so a call may queue another */
+  for (;;)
+    {
+      g_mutex_lock(&priv->calls_lock);
+      queued = g_queue_pop_head(&priv->calls);
+      g_mutex_unlock(&priv->calls_lock);
+      if (queued == NULL)
+        {
+          return;
+        }
+      queued->func(&queued->call);
+      _figure_queued_call_free(queued);
+    }
+}
+
+static gboolean _figure_run_calls_idle(gpointer self)
+{
+  /* unlocking on the main thread makes the calls, if the lock is
+     taken again its owner schedules another try */
+  if (slope_figure_try_lock(self))
+    {
+      slope_figure_unlock(self);
+    }
+  return G_SOURCE_REMOVE;
+}
+
+static void _figure_queued_call_free(gpointer data)
+{
+  SlopeFigureQueuedCall *queued = data;
+  g_object_unref(queued->call.object);
+  if (queued->call.keep != NULL)
+    {
+      g_object_unref(queued->call.keep);
+    }
+  if (queued->copied)
+    {
+      g_free(queued->call.p[0]);
+      g_free(queued->call.p[1]);
+    }
+  g_free(queued);
+}
+
+void _figure_set_cancellable(SlopeFigure *self, GCancellable *cancellable)
+{
+  SlopeFigurePrivate *priv = slope_figure_get_instance_private (self);
+  priv->cancellable = cancellable;
+}
+
+gboolean _figure_is_cancelled(SlopeFigure *self)
+{
+  SlopeFigurePrivate *priv = slope_figure_get_instance_private (self);
+  return priv->cancellable != NULL
+         && g_cancellable_is_cancelled(priv->cancellable);
+}
+
+static void _figure_set_frame_mode_call(const SlopeFigureCall *call)
+{
+  slope_figure_set_frame_mode(call->object, call->i[0]);
+}
+
+void slope_figure_set_frame_mode(SlopeFigure *self, SlopeFigureFrameMode mode)
+{
+  SlopeFigurePrivate *priv = slope_figure_get_instance_private (self);
+  SlopeFigureCall     call = {.object = self, .i = {mode}};
+  if (_figure_begin_change(self, _figure_set_frame_mode_call, &call))
+    {
+      priv->frame_mode = mode;
+      _figure_end_change(self);
+    }
+}
+
+SlopeFigureFrameMode slope_figure_get_frame_mode(SlopeFigure *self)
+{
+  SlopeFigurePrivate *priv = slope_figure_get_instance_private (self);
+  return priv->frame_mode;
+}
+
+static void _figure_set_parallel_call(const SlopeFigureCall *call)
+{
+  slope_figure_set_parallel(call->object, call->i[0]);
+}
+
+void slope_figure_set_parallel(SlopeFigure *self, gboolean parallel)
+{
+  SlopeFigurePrivate *priv = slope_figure_get_instance_private (self);
+  SlopeFigureCall     call = {.object = self, .i = {parallel}};
+  if (_figure_begin_change(self, _figure_set_parallel_call, &call))
+    {
+      priv->parallel = parallel;
+      _figure_end_change(self);
+    }
+}
+
+gboolean slope_figure_get_parallel(SlopeFigure *self)
+{
+  SlopeFigurePrivate *priv = slope_figure_get_instance_private (self);
+  return priv->parallel;
+}
+
+void slope_figure_set_profiling(SlopeFigure *self, gboolean profiling)
+{
+  SlopeFigurePrivate *priv = slope_figure_get_instance_private (self);
+  priv->profiling = profiling;
+  if (!profiling)
+    {
+      priv->show_stats = FALSE;
+    }
+}
+
+gboolean slope_figure_get_profiling(SlopeFigure *self)
+{
+  SlopeFigurePrivate *priv = slope_figure_get_instance_private (self);
+  return priv->profiling;
+}
+
+gboolean slope_figure_get_render_stats(SlopeFigure *self, SlopeRenderStats *stats)
+{
+  SlopeFigurePrivate *priv = slope_figure_get_instance_private (self);
+  g_mutex_lock(&priv->stats_lock);
+  *stats = priv->stats;
+  g_mutex_unlock(&priv->stats_lock);
+  return stats->frame > 0;
+}
+
+void slope_figure_set_show_stats(SlopeFigure *self, gboolean show)
+{
+  SlopeFigurePrivate *priv = slope_figure_get_instance_private (self);
+  priv->show_stats = show;
+  if (show)
+    {
+      priv->profiling = TRUE;
+    }
+}
+
+gboolean slope_figure_get_show_stats(SlopeFigure *self)
+{
+  SlopeFigurePrivate *priv = slope_figure_get_instance_private (self);
+  return priv->show_stats;
+}
+
+void _figure_invalidate(SlopeFigure *self)
+{
+  SlopeFigurePrivate *priv = slope_figure_get_instance_private (self);
+  GList *iter;
+  for (iter = priv->scale_list; iter != NULL; iter = iter->next)
+    {
+      slope_scale_invalidate(SLOPE_SCALE(iter->data));
+    }
+}
+
 void _figure_request_redraw(SlopeFigure *self)
 {
   SlopeFigurePrivate *priv = slope_figure_get_instance_private (self);
@@ -326,11 +1234,21 @@ slope_figure_get_background_color (SlopeFigure *self, GdkRGBA *color)
   *color = priv->background_color;
 }
 
+static void _figure_set_background_color_call(const SlopeFigureCall *call)
+{
+  slope_figure_set_background_color(call->object, call->p[0]);
+}
+
 void
 slope_figure_set_background_color (SlopeFigure *self, const GdkRGBA *color)
 {
   SlopeFigurePrivate *priv = slope_figure_get_instance_private (self);
-  priv->background_color = *color;
+  SlopeFigureCall     call = {.object = self, .p = {(gpointer) color}, .p_size = sizeof(GdkRGBA)};
+  if (_figure_begin_change(self, _figure_set_background_color_call, &call))
+    {
+      priv->background_color = *color;
+      _figure_end_change(self);
+    }
 }
 
 SlopeView *slope_figure_get_view(SlopeFigure *self)
@@ -362,9 +1280,19 @@ void slope_figure_draw(SlopeFigure *self, const graphene_rect_t *rect, cairo_t *
   SLOPE_FIGURE_GET_CLASS(self)->draw(self, rect, cr);
 }
 
+static void _figure_add_scale_call(const SlopeFigureCall *call)
+{
+  slope_figure_add_scale(call->object, call->keep);
+}
+
 void slope_figure_add_scale(SlopeFigure *self, SlopeScale *scale)
 {
-  SLOPE_FIGURE_GET_CLASS(self)->add_scale(self, scale);
+  SlopeFigureCall call = {.object = self, .keep = scale};
+  if (_figure_begin_change(self, _figure_add_scale_call, &call))
+    {
+      SLOPE_FIGURE_GET_CLASS(self)->add_scale(self, scale);
+      _figure_end_change(self);
+    }
 }
 
 /* slope/figure.c */
@@ -29,4 +29,54 @@ void _figure_handle_mouse_event(SlopeFigure *self, SlopeMouseEvent *event);
 
 void _figure_request_redraw(SlopeFigure *self);
 
+/* Lets every item take in data queued by producer threads */
+void _figure_sync(SlopeFigure *self);
+
+/* While set, scales draw from their retained images. render_scale
+ * is the pixel density the target will finally be shown at */
+void _figure_set_retained(SlopeFigure *self, gboolean retained, double render_scale);
+
+gboolean _figure_get_retained(SlopeFigure *self, double *render_scale);
+
+void _figure_invalidate(SlopeFigure *self);
+
+/* A frame being drawn on a worker thread gives up early once
+ * cancellable is triggered, the partial result is thrown away */
+void _figure_set_cancellable(SlopeFigure *self, GCancellable *cancellable);
+
+gboolean _figure_is_cancelled(SlopeFigure *self);
+
+/* A setter call put off while a worker draws the figure. object,
+ * and keep if set, are referenced until the call is made. p_size
+ * bytes are copied from each of the p pointers that is set, the
+ * others are kept as they are */
+typedef struct _SlopeFigureCall
+{
+  gpointer object;
+  gpointer keep;
+  gpointer p[2];
+  gsize    p_size;
+  double   d[4];
+  long     n;
+  int      i[2];
+} SlopeFigureCall;
+
+typedef void (*SlopeFigureCallFunc)(const SlopeFigureCall *call);
+
+/* Starts a change by a public setter to figure or to what it
+ * draws, figure may be NULL. The thread running the default main
+ * context never waits here: while another thread holds the lock,
+ * call is queued and FALSE returned, and func makes the call
+ * again on that thread once the lock is free. Changes queued
+ * before go in first. On TRUE the lock is held until
+ * _figure_end_change() */
+gboolean _figure_begin_change(SlopeFigure *          figure,
+                              SlopeFigureCallFunc    func,
+                              const SlopeFigureCall *call);
+
+void _figure_end_change(SlopeFigure *figure);
+
+/* The figure scale is drawn by, NULL for no scale or figure */
+SlopeFigure *_figure_of_scale(SlopeScale *scale);
+
 #endif /* SLOPE_FIGURE_P_H */
@@ -19,7 +19,9 @@
  */
 
 #include <slope/item_p.h>
+#include <slope/layer_p.h>
 #include <slope/scale_p.h>
+#include <slope/view_p.h>
 
 typedef struct _SlopeItemPrivate
 {
@@ -30,6 +32,9 @@ typedef struct _SlopeItemPrivate
   gboolean     managed;
   gboolean     visible;
   GList *      subitem_list;
+  gint         redraw_scheduled;
+  SlopeLayer * layer;
+  gint64       draw_time;
 } SlopeItemPrivate;
 
 G_DEFINE_TYPE_WITH_CODE (SlopeItem, slope_item, G_TYPE_OBJECT, G_ADD_PRIVATE (SlopeItem))
@@ -58,6 +63,9 @@ static void slope_item_init(SlopeItem *self)
   priv->managed          = TRUE;
   priv->visible          = TRUE;
   priv->subitem_list     = NULL;
+  priv->redraw_scheduled = 0;
+  priv->layer            = _layer_new();
+  priv->draw_time        = 0;
 }
 
 static void _item_finalize(GObject *self)
@@ -69,6 +77,7 @@ static void _item_finalize(GObject *self)
       g_list_free_full(priv->subitem_list, _item_clear_subitem_list);
       priv->subitem_list = NULL;
     }
+  _layer_destroy(priv->layer);
   G_OBJECT_CLASS(slope_item_parent_class)->finalize(self);
 }
 
@@ -80,6 +89,7 @@ void _item_set_scale(SlopeItem *self, SlopeScale *scale)
   priv->figure = (scale != NULL) ? slope_scale_get_figure(scale) : NULL;
   priv->view =
       (priv->figure != NULL) ? slope_figure_get_view(priv->figure) : NULL;
+  _layer_invalidate(priv->layer);
 }
 
 void slope_item_detach(SlopeItem *self)
@@ -110,9 +120,16 @@ void _item_mouse_event_impl(SlopeItem *self, SlopeMouseEvent *event)
 void _item_draw(SlopeItem *self, cairo_t *cr)
 {
   SlopeItemPrivate *priv = slope_item_get_instance_private (self);
+  gboolean          profiling;
+  gint64            begin = 0;
   /* draw this item's contents if it is visible */
   if (priv->visible)
     {
+      profiling = priv->figure != NULL && slope_figure_get_profiling(priv->figure);
+      if (profiling)
+        {
+          begin = g_get_monotonic_time();
+        }
       SLOPE_ITEM_GET_CLASS(self)->draw(self, cr);
       GList *subitem_iter = priv->subitem_list;
       /* and then draw subitems' contents on top of it */
@@ -121,6 +138,95 @@ void _item_draw(SlopeItem *self, cairo_t *cr)
           _item_draw(SLOPE_ITEM(subitem_iter->data), cr);
           subitem_iter = subitem_iter->next;
         }
+      if (profiling)
+        {
+          priv->draw_time = g_get_monotonic_time() - begin;
+        }
+    }
+}
+
+static void _item_draw_layer_func(cairo_t *cr, gpointer self)
+{
+  _item_draw(SLOPE_ITEM(self), cr);
+}
+
+void _item_draw_layered(SlopeItem *self, cairo_t *cr, double render_scale)
+{
+  SlopeItemPrivate *priv = slope_item_get_instance_private (self);
+  graphene_rect_t   clip;
+  double            x1, y1, x2, y2;
+  if (!priv->visible)
+    {
+      return;
+    }
+  /* stays so if the layer is reused */
+  priv->draw_time = 0;
+  cairo_clip_extents(cr, &x1, &y1, &x2, &y2);
+  graphene_rect_init (&clip, x1, y1, x2 - x1, y2 - y1);
+  if (!_layer_draw(priv->layer, cr, &clip, render_scale,
+                   _item_draw_layer_func, self))
+    {
+      _item_draw(self, cr);
+    }
+}
+
+void _item_scroll(SlopeItem *self, double dx, double dy)
+{
+  SlopeItemPrivate *priv = slope_item_get_instance_private (self);
+  _layer_scroll(priv->layer, dx, dy);
+}
+
+void slope_item_invalidate(SlopeItem *self)
+{
+  SlopeItemPrivate *priv = slope_item_get_instance_private (self);
+  /* subitems are drawn into their parent's layer */
+  _layer_invalidate(priv->layer);
+}
+
+void _item_sync(SlopeItem *self)
+{
+  SlopeItemPrivate *priv = slope_item_get_instance_private (self);
+  GList *           subitem_iter;
+  if (SLOPE_ITEM_GET_CLASS(self)->sync != NULL)
+    {
+      SLOPE_ITEM_GET_CLASS(self)->sync(self);
+    }
+  for (subitem_iter = priv->subitem_list; subitem_iter != NULL;
+       subitem_iter = subitem_iter->next)
+    {
+      _item_sync(SLOPE_ITEM(subitem_iter->data));
+    }
+}
+
+static gboolean _item_redraw_idle(gpointer data)
+{
+  SlopeItem *       self = SLOPE_ITEM(data);
+  SlopeItemPrivate *priv = slope_item_get_instance_private (self);
+  SlopeFigure *     figure;
+  g_atomic_int_set(&priv->redraw_scheduled, 0);
+  /* look the view up now, the item may have been placed in a
+   * figure after the producer started */
+  figure = (priv->scale != NULL) ? slope_scale_get_figure(priv->scale) : NULL;
+  if (figure != NULL && slope_figure_get_view(figure) != NULL)
+    {
+      /* only this item has anything new to show */
+      slope_item_invalidate(self);
+      _view_queue_frame(slope_figure_get_view(figure));
+    }
+  return G_SOURCE_REMOVE;
+}
+
+void _item_schedule_redraw(SlopeItem *self)
+{
+  SlopeItemPrivate *priv = slope_item_get_instance_private (self);
+  /* g_idle_add is safe from any thread, the reference keeps the
+   * item alive until the main loop runs the callback */
+  if (g_atomic_int_compare_and_exchange(&priv->redraw_scheduled, 0, 1))
+    {
+      g_idle_add_full(G_PRIORITY_DEFAULT_IDLE,
+                      _item_redraw_idle,
+                      g_object_ref(self),
+                      g_object_unref);
     }
 }
 
@@ -249,6 +355,12 @@ GList *slope_item_get_subitem_list(SlopeItem *self)
   return priv->subitem_list;
 }
 
+gint64 slope_item_get_draw_time(SlopeItem *self)
+{
+  SlopeItemPrivate *priv = slope_item_get_instance_private (self);
+  return priv->draw_time;
+}
+
 SlopeScale *slope_item_get_scale(SlopeItem *self)
 {
   SlopeItemPrivate *priv = slope_item_get_instance_private (self);
@@ -26,6 +26,12 @@
 
 void _item_draw(SlopeItem *self, cairo_t *cr);
 
+/* Like _item_draw(), but goes through the item's own layer covering
+ * the current clip, drawing only when the layer is dirty */
+void _item_draw_layered(SlopeItem *self, cairo_t *cr, double render_scale);
+
+void _item_scroll(SlopeItem *self, double dx, double dy);
+
 void _item_draw_thumb (SlopeItem *self, cairo_t *cr, const graphene_point_t *pos);
 
 void _item_set_scale(SlopeItem *self, SlopeScale *scale);
@@ -34,4 +40,12 @@ void _item_handle_mouse_event(SlopeItem *self, SlopeMouseEvent *event);
 
 void _item_mouse_event_impl(SlopeItem *self, SlopeMouseEvent *event);
 
+/* Gives the item a chance to take in data produced by other
+ * threads, called from the main thread before each frame */
+void _item_sync(SlopeItem *self);
+
+/* Asks for a redraw of the item's view from any thread, repeated
+ * calls before the main loop gets to it are merged into one */
+void _item_schedule_redraw(SlopeItem *self);
+
 #endif /* SLOPE_ITEM_P_H */
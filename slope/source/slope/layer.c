@@ -0,0 +1,336 @@
+/*
+ * Copyright (C) 2017,2023  Elvis Teixeira, Anatoliy Sokolov
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <slope/drawing_p.h>
+#include <slope/layer_p.h>
+
+/* beyond this drawing directly is cheaper than keeping the pixels */
+#define LAYER_MAX_SIDE 8192.0
+
+struct _SlopeLayer
+{
+  cairo_surface_t *surface;
+  /* bumped by every invalidation, possibly from another thread
+     than the one drawing, the content is current while it equals
+     the serial it was drawn for */
+  gint             serial;
+  gint             drawn_serial;
+  gint             drawing_serial;
+  graphene_rect_t  rect;
+  double           pixel_scale;
+  /* device pixel of the image's top left corner */
+  double           x0, y0;
+  /* image pixels left uncovered by _layer_scroll() */
+  cairo_region_t * exposed;
+};
+
+static cairo_t *_layer_create_context(SlopeLayer *self, cairo_t *target);
+
+SlopeLayer *_layer_new(void)
+{
+  SlopeLayer *self     = g_new(SlopeLayer, 1);
+  self->surface        = NULL;
+  self->serial         = 1;
+  self->drawn_serial   = 0;
+  self->drawing_serial = 0;
+  self->rect           = GRAPHENE_RECT_INIT (0.0, 0.0, 0.0, 0.0);
+  self->pixel_scale    = 0.0;
+  self->x0             = 0.0;
+  self->y0             = 0.0;
+  self->exposed        = cairo_region_create();
+  return self;
+}
+
+void _layer_destroy(SlopeLayer *self)
+{
+  if (self == NULL)
+    {
+      return;
+    }
+  if (self->surface != NULL)
+    {
+      cairo_surface_destroy(self->surface);
+    }
+  cairo_region_destroy(self->exposed);
+  g_free(self);
+}
+
+void _layer_invalidate(SlopeLayer *self)
+{
+  g_atomic_int_inc(&self->serial);
+}
+
+gboolean _layer_is_dirty(SlopeLayer *self)
+{
+  return g_atomic_int_get(&self->serial) != self->drawn_serial;
+}
+
+gboolean _layer_prepare(SlopeLayer *           self,
+                        cairo_t *              target,
+                        const graphene_rect_t *rect,
+                        double                 render_scale)
+{
+  cairo_matrix_t m;
+  double         device_scale;
+  double         pixel_scale;
+  double         width, height;
+
+  if (_drawing_target_is_vector(target)
+      || !_drawing_get_pixel_transform(target, &m, &device_scale)
+      || m.xx <= 0.0)
+    {
+      return FALSE;
+    }
+  pixel_scale = m.xx * device_scale * render_scale;
+  width       = graphene_rect_get_width (rect) * pixel_scale;
+  height      = graphene_rect_get_height (rect) * pixel_scale;
+  if (!(width >= 1.0 && height >= 1.0)
+      || width > LAYER_MAX_SIDE || height > LAYER_MAX_SIDE)
+    {
+      return FALSE;
+    }
+  if (self->pixel_scale != pixel_scale
+      || !graphene_rect_equal(&self->rect, rect))
+    {
+      self->rect        = *rect;
+      self->pixel_scale = pixel_scale;
+      _layer_invalidate(self);
+    }
+  return TRUE;
+}
+
+static cairo_t *_layer_create_context(SlopeLayer *self, cairo_t *target)
+{
+  cairo_font_options_t *font_options;
+  cairo_matrix_t        font_matrix;
+  cairo_t *             layer_cr = cairo_create(self->surface);
+
+  /* carry over the text setup the figure gave to target */
+  font_options = cairo_font_options_create();
+  cairo_get_font_options(target, font_options);
+  cairo_set_font_options(layer_cr, font_options);
+  cairo_font_options_destroy(font_options);
+  cairo_set_font_face(layer_cr, cairo_get_font_face(target));
+  cairo_get_font_matrix(target, &font_matrix);
+  cairo_set_font_matrix(layer_cr, &font_matrix);
+  cairo_set_antialias(layer_cr, cairo_get_antialias(target));
+  return layer_cr;
+}
+
+cairo_t *_layer_begin(SlopeLayer *self, cairo_t *target)
+{
+  cairo_t *layer_cr;
+  int      width, height;
+
+  self->drawing_serial = g_atomic_int_get(&self->serial);
+  /* the image starts on a whole pixel so that compositing it
+     back needs no resampling */
+  self->x0 = floor(graphene_rect_get_x (&self->rect) * self->pixel_scale);
+  self->y0 = floor(graphene_rect_get_y (&self->rect) * self->pixel_scale);
+  width    = (int) (ceil((graphene_rect_get_x (&self->rect)
+                          + graphene_rect_get_width (&self->rect)) * self->pixel_scale) - self->x0);
+  height   = (int) (ceil((graphene_rect_get_y (&self->rect)
+                          + graphene_rect_get_height (&self->rect)) * self->pixel_scale) - self->y0);
+
+  if (self->surface != NULL
+      && (cairo_image_surface_get_width(self->surface) != width
+          || cairo_image_surface_get_height(self->surface) != height))
+    {
+      cairo_surface_destroy(self->surface);
+      self->surface = NULL;
+    }
+  if (self->surface == NULL)
+    {
+      self->surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+      if (cairo_surface_status(self->surface) != CAIRO_STATUS_SUCCESS)
+        {
+          cairo_surface_destroy(self->surface);
+          self->surface = NULL;
+          return NULL;
+        }
+    }
+  cairo_surface_set_device_scale(self->surface, self->pixel_scale, self->pixel_scale);
+  cairo_surface_set_device_offset(self->surface, -self->x0, -self->y0);
+
+  layer_cr = _layer_create_context(self, target);
+  cairo_set_operator(layer_cr, CAIRO_OPERATOR_CLEAR);
+  cairo_paint(layer_cr);
+  cairo_set_operator(layer_cr, CAIRO_OPERATOR_OVER);
+  return layer_cr;
+}
+
+void _layer_end(SlopeLayer *self, cairo_t *layer_cr)
+{
+  cairo_destroy(layer_cr);
+  self->drawn_serial = self->drawing_serial;
+  cairo_region_destroy(self->exposed);
+  self->exposed = cairo_region_create();
+}
+
+void _layer_scroll(SlopeLayer *self, double dx, double dy)
+{
+  cairo_rectangle_int_t strip;
+  unsigned char *       data;
+  int                   width, height, stride;
+  int                   px, py, row, n_bytes;
+
+  if (_layer_is_dirty(self) || self->surface == NULL)
+    {
+      return;
+    }
+  px     = (int) lround(dx * self->pixel_scale);
+  py     = (int) lround(dy * self->pixel_scale);
+  width  = cairo_image_surface_get_width(self->surface);
+  height = cairo_image_surface_get_height(self->surface);
+  if (px == 0 && py == 0)
+    {
+      return;
+    }
+  if (abs(px) >= width || abs(py) >= height)
+    {
+      _layer_invalidate(self);
+      return;
+    }
+
+  /* move the pixels in place, walking the rows against the
+     direction of the motion so nothing is read after it was
+     overwritten */
+  cairo_surface_flush(self->surface);
+  data    = cairo_image_surface_get_data(self->surface);
+  stride  = cairo_image_surface_get_stride(self->surface);
+  n_bytes = (width - abs(px)) * 4;
+  if (py > 0)
+    {
+      for (row = height - 1; row >= py; --row)
+        {
+          memmove(data + row * stride + SLOPE_MAX(px, 0) * 4,
+                  data + (row - py) * stride + SLOPE_MAX(-px, 0) * 4,
+                  n_bytes);
+        }
+    }
+  else
+    {
+      for (row = 0; row < height + py; ++row)
+        {
+          memmove(data + row * stride + SLOPE_MAX(px, 0) * 4,
+                  data + (row - py) * stride + SLOPE_MAX(-px, 0) * 4,
+                  n_bytes);
+        }
+    }
+  cairo_surface_mark_dirty(self->surface);
+
+  /* what was still pending moves along with the content, then
+     the uncovered L shaped border is added */
+  cairo_region_translate(self->exposed, px, py);
+  strip.x      = (px > 0) ? 0 : width + px;
+  strip.y      = 0;
+  strip.width  = abs(px);
+  strip.height = height;
+  cairo_region_union_rectangle(self->exposed, &strip);
+  strip.x      = 0;
+  strip.y      = (py > 0) ? 0 : height + py;
+  strip.width  = width;
+  strip.height = abs(py);
+  cairo_region_union_rectangle(self->exposed, &strip);
+  strip.x      = 0;
+  strip.y      = 0;
+  strip.height = height;
+  cairo_region_intersect_rectangle(self->exposed, &strip);
+}
+
+void _layer_composite(SlopeLayer *self, cairo_t *target)
+{
+  if (self->surface == NULL)
+    {
+      return;
+    }
+  cairo_save(target);
+  cairo_set_source_surface(target, self->surface, 0.0, 0.0);
+  cairo_new_path(target);
+  slope_cairo_rect (target, &self->rect);
+  cairo_fill(target);
+  cairo_restore(target);
+}
+
+static void _layer_draw_exposed(SlopeLayer *       self,
+                                cairo_t *          target,
+                                SlopeLayerDrawFunc func,
+                                gpointer           user_data)
+{
+  cairo_rectangle_int_t strip;
+  cairo_t *             layer_cr = _layer_create_context(self, target);
+  int                   k, n_strips;
+
+  self->drawing_serial = g_atomic_int_get(&self->serial);
+
+  /* clip to the strips, in user space, and draw only there */
+  n_strips = cairo_region_num_rectangles(self->exposed);
+  cairo_new_path(layer_cr);
+  for (k = 0; k < n_strips; ++k)
+    {
+      cairo_region_get_rectangle(self->exposed, k, &strip);
+      cairo_rectangle(layer_cr,
+                      (strip.x + self->x0) / self->pixel_scale,
+                      (strip.y + self->y0) / self->pixel_scale,
+                      strip.width / self->pixel_scale,
+                      strip.height / self->pixel_scale);
+    }
+  cairo_clip(layer_cr);
+  cairo_set_operator(layer_cr, CAIRO_OPERATOR_CLEAR);
+  cairo_paint(layer_cr);
+  cairo_set_operator(layer_cr, CAIRO_OPERATOR_OVER);
+  func(layer_cr, user_data);
+  _layer_end(self, layer_cr);
+}
+
+gboolean _layer_draw(SlopeLayer *           self,
+                     cairo_t *              target,
+                     const graphene_rect_t *rect,
+                     double                 render_scale,
+                     SlopeLayerDrawFunc     func,
+                     gpointer               user_data)
+{
+  cairo_t *layer_cr;
+  if (!_layer_prepare(self, target, rect, render_scale))
+    {
+      return FALSE;
+    }
+  if (_layer_is_dirty(self))
+    {
+      layer_cr = _layer_begin(self, target);
+      if (layer_cr == NULL)
+        {
+          return FALSE;
+        }
+      func(layer_cr, user_data);
+      _layer_end(self, layer_cr);
+    }
+  else if (!cairo_region_is_empty(self->exposed))
+    {
+      _layer_draw_exposed(self, target, func, user_data);
+    }
+  _layer_composite(self, target);
+  return TRUE;
+}
+
+/* slope/layer.c */
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2017,2023  Elvis Teixeira, Anatoliy Sokolov
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SLOPE_LAYER_P_H
+#define SLOPE_LAYER_P_H
+
+#include <slope/drawing.h>
+
+/* A retained image of part of a frame. The owner draws into it
+ * only when it is dirty or the target geometry changed, and every
+ * frame composites it back, which is a plain pixel copy. */
+typedef struct _SlopeLayer SlopeLayer;
+
+typedef void (*SlopeLayerDrawFunc)(cairo_t *cr, gpointer user_data);
+
+SlopeLayer *_layer_new(void);
+
+void _layer_destroy(SlopeLayer *self);
+
+void _layer_invalidate(SlopeLayer *self);
+
+/* Keys the layer on rect (user space of target) and the target's
+ * pixel density, times render_scale when the target is itself
+ * scaled later. Returns FALSE if target can not use an image (vector
+ * output, rotated transform, huge area) and the content must be
+ * drawn directly */
+gboolean _layer_prepare(SlopeLayer *           self,
+                        cairo_t *              target,
+                        const graphene_rect_t *rect,
+                        double                 render_scale);
+
+gboolean _layer_is_dirty(SlopeLayer *self);
+
+/* Returns a context for drawing the content with the same user
+ * space and text settings as target, or NULL on allocation failure */
+cairo_t *_layer_begin(SlopeLayer *self, cairo_t *target);
+
+void _layer_end(SlopeLayer *self, cairo_t *layer_cr);
+
+void _layer_composite(SlopeLayer *self, cairo_t *target);
+
+/* Moves the content by (dx, dy) figure units, rounded to whole
+ * pixels, so that the next _layer_draw() only draws what scrolled
+ * into view. Does nothing to a dirty layer */
+void _layer_scroll(SlopeLayer *self, double dx, double dy);
+
+/* The whole cycle: prepare, draw with func if dirty (or clipped to
+ * the strips uncovered by scrolling), composite.
+ * Returns FALSE, having drawn nothing, when the caller must draw
+ * directly on target */
+gboolean _layer_draw(SlopeLayer *           self,
+                     cairo_t *              target,
+                     const graphene_rect_t *rect,
+                     double                 render_scale,
+                     SlopeLayerDrawFunc     func,
+                     gpointer               user_data);
+
+#endif /* SLOPE_LAYER_P_H */
@@ -19,7 +19,7 @@
  */
 
 #include <slope/item_p.h>
-#include <slope/legend.h>
+#include <slope/legend_p.h>
 #include <slope/scale.h>
 
 typedef struct _SlopeLegendPrivate
@@ -52,7 +52,6 @@ static void _legend_get_data_rect (SlopeItem *self, graphene_rect_t *rect);
 static void _legend_draw_rect(SlopeItem *self, cairo_t *cr);
 static void _legend_draw_thumbs(SlopeItem *self, cairo_t *cr);
 static void _legend_evaluate_rect(SlopeItem *self, cairo_t *cr);
-static void _legend_evaluate_extents(SlopeItem *self, cairo_t *cr);
 
 static void slope_legend_class_init(SlopeLegendClass *klass)
 {
@@ -109,7 +108,7 @@ static void _legend_draw(SlopeItem *self, cairo_t *cr)
   _legend_draw_thumbs(self, cr);
 }
 
-static void _legend_evaluate_extents(SlopeItem *self, cairo_t *cr)
+void _legend_evaluate_extents(SlopeItem *self, cairo_t *cr)
 {
   SlopeLegendPrivate *priv = slope_legend_get_instance_private (SLOPE_LEGEND (self));
   priv->rect.size = GRAPHENE_SIZE_INIT_ZERO;
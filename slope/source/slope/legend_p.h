@@ -0,0 +1,30 @@
+/*
+ * Copyright (C) 2017,2023  Elvis Teixeira, Anatoliy Sokolov
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SLOPE_LEGEND_P_H
+#define SLOPE_LEGEND_P_H
+
+#include <slope/legend.h>
+
+/* Measures the names of the visible items with the font of cr,
+ * the first step of drawing the legend */
+void _legend_evaluate_extents(SlopeItem *self, cairo_t *cr);
+
+#endif /* SLOPE_LEGEND_P_H */
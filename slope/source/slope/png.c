@@ -0,0 +1,249 @@
+/*
+ * Copyright (C) 2017,2023  Elvis Teixeira, Anatoliy Sokolov
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gio/gio.h>
+#include <string.h>
+#include <slope/png_p.h>
+
+/* compressed data is written in chunks of up to this size */
+#define PNG_IDAT_SIZE 65536
+
+struct _SlopePngWriter
+{
+  cairo_write_func_t write_func;
+  void *             closure;
+  int                width;
+  int                height;
+  GConverter *       compressor;
+  unsigned char      idat[PNG_IDAT_SIZE];
+  gsize              idat_used;
+  cairo_status_t     status;
+};
+
+static guint32 png_crc_table[256];
+
+static void _png_init_crc_table(void)
+{
+  static gsize table_init = 0;
+  if (g_once_init_enter(&table_init))
+    {
+      guint32 n, k, c;
+      for (n = 0; n < 256; ++n)
+        {
+          c = n;
+          for (k = 0; k < 8; ++k)
+            {
+              c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            }
+          png_crc_table[n] = c;
+        }
+      g_once_init_leave(&table_init, 1);
+    }
+}
+
+static guint32 _png_crc(guint32 crc, const unsigned char *data, gsize size)
+{
+  gsize k;
+  for (k = 0; k < size; ++k)
+    {
+      crc = png_crc_table[(crc ^ data[k]) & 0xff] ^ (crc >> 8);
+    }
+  return crc;
+}
+
+static void _png_put_u32(unsigned char *dest, guint32 value)
+{
+  dest[0] = (unsigned char) (value >> 24);
+  dest[1] = (unsigned char) (value >> 16);
+  dest[2] = (unsigned char) (value >> 8);
+  dest[3] = (unsigned char) value;
+}
+
+static void _png_write(SlopePngWriter *self, const unsigned char *data, gsize size)
+{
+  if (self->status == CAIRO_STATUS_SUCCESS && size > 0)
+    {
+      self->status = self->write_func(self->closure, data, (unsigned int) size);
+    }
+}
+
+static void _png_write_chunk(SlopePngWriter *     self,
+                             const char *         type,
+                             const unsigned char *data,
+                             gsize                size)
+{
+  unsigned char head[8], tail[4];
+  guint32       crc;
+  _png_put_u32(head, (guint32) size);
+  memcpy(head + 4, type, 4);
+  crc = _png_crc(0xffffffffu, head + 4, 4);
+  crc = _png_crc(crc, data, size);
+  _png_put_u32(tail, crc ^ 0xffffffffu);
+  _png_write(self, head, 8);
+  _png_write(self, data, size);
+  _png_write(self, tail, 4);
+}
+
+static void _png_flush_idat(SlopePngWriter *self)
+{
+  if (self->idat_used > 0)
+    {
+      _png_write_chunk(self, "IDAT", self->idat, self->idat_used);
+      self->idat_used = 0;
+    }
+}
+
+static void _png_deflate(SlopePngWriter *     self,
+                         const unsigned char *data,
+                         gsize                size,
+                         GConverterFlags      flags)
+{
+  GConverterResult result;
+  GError *         error = NULL;
+  gsize            n_read, n_written;
+  do
+    {
+      result = g_converter_convert(self->compressor,
+                                   data, size,
+                                   self->idat + self->idat_used,
+                                   PNG_IDAT_SIZE - self->idat_used,
+                                   flags, &n_read, &n_written, &error);
+      if (result == G_CONVERTER_ERROR)
+        {
+          g_error_free(error);
+          self->status = CAIRO_STATUS_NO_MEMORY;
+          return;
+        }
+      data += n_read;
+      size -= n_read;
+      self->idat_used += n_written;
+      if (self->idat_used == PNG_IDAT_SIZE)
+        {
+          _png_flush_idat(self);
+        }
+    }
+  while (self->status == CAIRO_STATUS_SUCCESS
+         && (size > 0
+             || ((flags & G_CONVERTER_INPUT_AT_END) && result != G_CONVERTER_FINISHED)));
+}
+
+SlopePngWriter *_png_writer_new(cairo_write_func_t write_func,
+                                void *             closure,
+                                int                width,
+                                int                height)
+{
+  static const unsigned char signature[8] = {137, 80, 78, 71, 13, 10, 26, 10};
+  SlopePngWriter *self = g_new(SlopePngWriter, 1);
+  unsigned char   ihdr[13];
+
+  _png_init_crc_table();
+  self->write_func = write_func;
+  self->closure    = closure;
+  self->width      = width;
+  self->height     = height;
+  self->compressor = G_CONVERTER(g_zlib_compressor_new(G_ZLIB_COMPRESSOR_FORMAT_ZLIB, 6));
+  self->idat_used  = 0;
+  self->status     = CAIRO_STATUS_SUCCESS;
+
+  /* 8 bits per channel RGBA, no interlacing */
+  _png_put_u32(ihdr, (guint32) width);
+  _png_put_u32(ihdr + 4, (guint32) height);
+  ihdr[8]  = 8;
+  ihdr[9]  = 6;
+  ihdr[10] = 0;
+  ihdr[11] = 0;
+  ihdr[12] = 0;
+  _png_write(self, signature, 8);
+  _png_write_chunk(self, "IHDR", ihdr, 13);
+  return self;
+}
+
+gsize _png_writer_get_rows_size(SlopePngWriter *self, int n_rows)
+{
+  /* every row starts with its filter type */
+  return (gsize) n_rows * (1 + (gsize) self->width * 4);
+}
+
+void _png_writer_convert_rows(SlopePngWriter *     self,
+                              const unsigned char *image_data,
+                              int                  image_stride,
+                              int                  n_rows,
+                              unsigned char *      rows)
+{
+  gsize row_size = _png_writer_get_rows_size(self, 1);
+  int   row, k;
+
+  for (row = 0; row < n_rows; ++row)
+    {
+      const guint32 *src  = (const guint32 *) (image_data + (gsize) row * image_stride);
+      unsigned char *dest = rows + (gsize) row * row_size;
+      gsize          i;
+
+      /* cairo keeps native endian premultiplied ARGB */
+      dest[0] = 1;
+      for (k = 0; k < self->width; ++k)
+        {
+          guint32        pixel = src[k];
+          guint32        alpha = pixel >> 24;
+          unsigned char *px    = dest + 1 + k * 4;
+          if (alpha == 0)
+            {
+              px[0] = px[1] = px[2] = px[3] = 0;
+              continue;
+            }
+          px[0] = (unsigned char) ((((pixel >> 16) & 0xff) * 255 + alpha / 2) / alpha);
+          px[1] = (unsigned char) ((((pixel >> 8) & 0xff) * 255 + alpha / 2) / alpha);
+          px[2] = (unsigned char) (((pixel & 0xff) * 255 + alpha / 2) / alpha);
+          px[3] = (unsigned char) alpha;
+        }
+      /* the Sub filter turns the flat runs a chart is made of into
+         zeros, from the end so each byte sees its unfiltered left
+         neighbour */
+      for (i = row_size - 1; i > 4; --i)
+        {
+          dest[i] = (unsigned char) (dest[i] - dest[i - 4]);
+        }
+    }
+}
+
+cairo_status_t _png_writer_write_rows(SlopePngWriter *     self,
+                                      const unsigned char *rows,
+                                      int                  n_rows)
+{
+  if (n_rows > 0)
+    {
+      _png_deflate(self, rows, _png_writer_get_rows_size(self, n_rows), G_CONVERTER_NO_FLAGS);
+    }
+  return self->status;
+}
+
+cairo_status_t _png_writer_finish(SlopePngWriter *self)
+{
+  cairo_status_t status;
+  _png_deflate(self, NULL, 0, G_CONVERTER_INPUT_AT_END);
+  _png_flush_idat(self);
+  _png_write_chunk(self, "IEND", NULL, 0);
+  status = self->status;
+  g_object_unref(self->compressor);
+  g_free(self);
+  return status;
+}
+
+/* slope/png.c */
@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2017,2023  Elvis Teixeira, Anatoliy Sokolov
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SLOPE_PNG_P_H
+#define SLOPE_PNG_P_H
+
+#include <slope/drawing.h>
+
+/* PNG encoder fed a band of rows at a time, for images too large
+ * to be held in one cairo surface. Writes 8 bit RGBA through
+ * write_func as the rows come in. */
+typedef struct _SlopePngWriter SlopePngWriter;
+
+SlopePngWriter *_png_writer_new(cairo_write_func_t write_func,
+                                void *             closure,
+                                int                width,
+                                int                height);
+
+/* Size in bytes of n_rows encoder rows of the writer's width */
+gsize _png_writer_get_rows_size(SlopePngWriter *self, int n_rows);
+
+/* Converts n_rows of an ARGB32 image into encoder rows. Touches
+ * nothing but its arguments, so bands can be converted in
+ * parallel. */
+void _png_writer_convert_rows(SlopePngWriter *     self,
+                              const unsigned char *image_data,
+                              int                  image_stride,
+                              int                  n_rows,
+                              unsigned char *      rows);
+
+/* Compresses and writes converted rows, top to bottom */
+cairo_status_t _png_writer_write_rows(SlopePngWriter *     self,
+                                      const unsigned char *rows,
+                                      int                  n_rows);
+
+/* Writes the end of the stream and frees the writer, returns the
+ * first error met along the way */
+cairo_status_t _png_writer_finish(SlopePngWriter *self);
+
+#endif /* SLOPE_PNG_P_H */
@@ -0,0 +1,274 @@
+/*
+ * Copyright (C) 2017,2023  Elvis Teixeira, Anatoliy Sokolov
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <slope/pyramid_p.h>
+
+#define PYRAMID_MAX_LEVELS 64
+
+typedef struct _SlopePyramid
+{
+  SlopePyramidLevel level[PYRAMID_MAX_LEVELS];
+  int               n_levels;
+  gsize             budget;
+  SlopeSamples      y;
+  long              n_pts;
+} SlopePyramid;
+
+static long _pyramid_base_block_size(SlopePyramid *self, long n_pts);
+static void _pyramid_build(SlopePyramid *self, long n_pts, long first_pt);
+
+SlopePyramid *_pyramid_new(void)
+{
+  SlopePyramid *self = g_malloc0(sizeof(SlopePyramid));
+
+  self->n_levels = 0;
+  self->budget   = 0;
+  _samples_init(&self->y, NULL, SLOPE_SAMPLE_DOUBLE, 1.0, 0.0);
+  self->n_pts    = 0L;
+
+  return self;
+}
+
+void _pyramid_destroy(SlopePyramid *self)
+{
+  _pyramid_clear(self);
+  g_free(self);
+}
+
+void _pyramid_clear(SlopePyramid *self)
+{
+  int k;
+  for (k = 0; k < self->n_levels; ++k)
+    {
+      g_free(self->level[k].min_idx);
+      g_free(self->level[k].max_idx);
+      self->level[k].min_idx  = NULL;
+      self->level[k].max_idx  = NULL;
+      self->level[k].n_blocks = 0L;
+    }
+  self->n_levels = 0;
+  self->y.data   = NULL;
+  self->n_pts    = 0L;
+}
+
+void _pyramid_set_budget(SlopePyramid *self, gsize budget)
+{
+  if (self->budget != budget)
+    {
+      self->budget = budget;
+      _pyramid_clear(self);
+    }
+}
+
+gsize _pyramid_get_budget(SlopePyramid *self) { return self->budget; }
+
+static long _pyramid_base_block_size(SlopePyramid *self, long n_pts)
+{
+  /* all levels together take about twice the memory of level 0,
+     which stores two indexes per block */
+  long block_size = 2L;
+  while (block_size < n_pts &&
+         4 * sizeof(long) * (gsize)((n_pts + block_size - 1) / block_size) >
+             self->budget)
+    {
+      block_size *= 2L;
+    }
+  return block_size;
+}
+
+void _pyramid_update(SlopePyramid *      self,
+                     const SlopeSamples *y,
+                     long                n_pts,
+                     gboolean            append)
+{
+  long first_pt = 0L;
+  long base;
+
+  if (self->budget == 0 || y->data == NULL || n_pts < 1L)
+    {
+      _pyramid_clear(self);
+      return;
+    }
+
+  base = _pyramid_base_block_size(self, n_pts);
+  if (append && self->n_levels > 0 && _samples_equal(y, &self->y)
+      && n_pts >= self->n_pts && base == self->level[0].block_size)
+    {
+      /* same buffer growing: the blocks before the last (possibly
+         partial) one are already right */
+      first_pt = self->n_pts;
+    }
+  else
+    {
+      _pyramid_clear(self);
+      self->level[0].block_size = base;
+    }
+
+  self->y = *y;
+  _pyramid_build(self, n_pts, first_pt);
+  self->n_pts = n_pts;
+}
+
+static void _pyramid_build(SlopePyramid *self, long n_pts, long first_pt)
+{
+  const SlopeSamples *y = &self->y;
+  double              buf[SAMPLES_CHUNK];
+  long                block_size = self->level[0].block_size;
+  long                n_blocks   = (n_pts + block_size - 1) / block_size;
+  long                first_block = first_pt / block_size;
+  int                 l = 0;
+
+  while (TRUE)
+    {
+      SlopePyramidLevel *level = &self->level[l];
+      long               b;
+
+      level->block_size = block_size;
+      level->min_idx    = g_renew(long, level->min_idx, n_blocks);
+      level->max_idx    = g_renew(long, level->max_idx, n_blocks);
+      level->n_blocks   = n_blocks;
+
+      for (b = first_block; b < n_blocks; ++b)
+        {
+          long k, k_min, k_max;
+          if (l == 0)
+            {
+              long          end = SLOPE_MIN((b + 1) * block_size, n_pts);
+              long          k0, n;
+              const double *v;
+              double        v_min, v_max;
+              k_min = k_max = b * block_size;
+              v_min = v_max = _samples_get(y, k_min);
+              /* read in chunks, converting when the data is not
+                 plain doubles */
+              for (k0 = k_min + 1; k0 < end; k0 += n)
+                {
+                  n = SLOPE_MIN(end - k0, SAMPLES_CHUNK);
+                  v = _samples_read(y, k0, n, buf);
+                  for (k = 0; k < n; ++k)
+                    {
+                      if (v[k] < v_min) { v_min = v[k]; k_min = k0 + k; }
+                      if (v[k] > v_max) { v_max = v[k]; k_max = k0 + k; }
+                    }
+                }
+            }
+          else
+            {
+              SlopePyramidLevel *prev = &self->level[l - 1];
+              k_min = prev->min_idx[2 * b];
+              k_max = prev->max_idx[2 * b];
+              if (2 * b + 1 < prev->n_blocks)
+                {
+                  k = prev->min_idx[2 * b + 1];
+                  if (_samples_get(y, k) < _samples_get(y, k_min)) k_min = k;
+                  k = prev->max_idx[2 * b + 1];
+                  if (_samples_get(y, k) > _samples_get(y, k_max)) k_max = k;
+                }
+            }
+          level->min_idx[b] = k_min;
+          level->max_idx[b] = k_max;
+        }
+
+      if (n_blocks == 1L || l + 1 == PYRAMID_MAX_LEVELS)
+        {
+          break;
+        }
+      l += 1;
+      block_size *= 2L;
+      n_blocks    = (n_blocks + 1L) / 2L;
+      first_block = first_block / 2L;
+    }
+
+  /* release levels left from a previous, bigger data set */
+  while (self->n_levels > l + 1)
+    {
+      self->n_levels -= 1;
+      g_free(self->level[self->n_levels].min_idx);
+      g_free(self->level[self->n_levels].max_idx);
+      self->level[self->n_levels].min_idx = NULL;
+      self->level[self->n_levels].max_idx = NULL;
+    }
+  self->n_levels = l + 1;
+}
+
+const SlopePyramidLevel *_pyramid_select_level(SlopePyramid *self,
+                                               long          n_visible,
+                                               long          n_pixels)
+{
+  const SlopePyramidLevel *best = NULL;
+  int                      k;
+  /* the coarsest level that still gives at least one block per pixel */
+  for (k = 0; k < self->n_levels; ++k)
+    {
+      if (n_visible / self->level[k].block_size < n_pixels)
+        {
+          break;
+        }
+      best = &self->level[k];
+    }
+  return best;
+}
+
+long _pyramid_get_block_size(SlopePyramid *self)
+{
+  return (self->n_levels > 0) ? self->level[0].block_size : 0L;
+}
+
+long _pyramid_next_block(SlopePyramid *self,
+                         long          b,
+                         double        v_lo,
+                         double        v_hi,
+                         int *         side)
+{
+  int l = 0;
+  while (b < self->level[l].n_blocks)
+    {
+      const SlopePyramidLevel *level = &self->level[l];
+      int                      s     = 0;
+      /* NaNs never rule a block out */
+      if (_samples_get(&self->y, level->max_idx[b]) < v_lo)
+        s = -1;
+      else if (_samples_get(&self->y, level->min_idx[b]) > v_hi)
+        s = 1;
+      if (s == 0 || (*side != 0 && s != *side))
+        {
+          if (l == 0)
+            {
+              *side = s;
+              return b;
+            }
+          /* the first of its children is the one looked for */
+          l -= 1;
+          b *= 2L;
+          continue;
+        }
+      *side = s;
+      b += 1L;
+      /* past the last child: go on with the next parent at once */
+      while ((b & 1L) == 0L && l + 1 < self->n_levels)
+        {
+          b /= 2L;
+          l += 1;
+        }
+    }
+  return self->level[0].n_blocks;
+}
+
+/* slope/pyramid.c */
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2017,2023  Elvis Teixeira, Anatoliy Sokolov
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SLOPE_PYRAMID_P_H
+#define SLOPE_PYRAMID_P_H
+
+#include <slope/samples_p.h>
+
+/* Level of detail pyramid over a series' y data. Level 0 splits
+ * the samples in blocks of a power of two size and stores the
+ * index of the minimum and maximum sample of each block, every
+ * following level merges pairs of blocks of the previous one. The
+ * base block size is chosen so that the whole pyramid fits in the
+ * configured memory budget. */
+typedef struct _SlopePyramid SlopePyramid;
+
+typedef struct _SlopePyramidLevel
+{
+  long *min_idx;
+  long *max_idx;
+  long  n_blocks;
+  long  block_size;
+} SlopePyramidLevel;
+
+SlopePyramid *_pyramid_new(void);
+
+void _pyramid_destroy(SlopePyramid *self);
+
+void _pyramid_set_budget(SlopePyramid *self, gsize budget);
+
+gsize _pyramid_get_budget(SlopePyramid *self);
+
+void _pyramid_clear(SlopePyramid *self);
+
+/* Builds the pyramid over the n_pts samples of y. With append the
+ * caller tells that y only grew since the last update, and only
+ * the blocks past the old end are built when y is the same array */
+void _pyramid_update(SlopePyramid *      self,
+                     const SlopeSamples *y,
+                     long                n_pts,
+                     gboolean            append);
+
+const SlopePyramidLevel *_pyramid_select_level(SlopePyramid *self,
+                                               long          n_visible,
+                                               long          n_pixels);
+
+/* Size of the level 0 blocks, 0 while the pyramid is empty */
+long _pyramid_get_block_size(SlopePyramid *self);
+
+/* First level 0 block, at or after b, whose samples may fall in
+ * [v_lo, v_hi], or the level 0 block count when none does. side
+ * tells on which side of the range the last skipped blocks lie
+ * (start with 0): a block lying on the other one is returned as
+ * well, the segment joining them may cross the range */
+long _pyramid_next_block(SlopePyramid *self,
+                         long          b,
+                         double        v_lo,
+                         double        v_hi,
+                         int *         side);
+
+#endif /* SLOPE_PYRAMID_P_H */
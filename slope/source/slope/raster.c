@@ -0,0 +1,299 @@
+/*
+ * Copyright (C) 2017,2023  Elvis Teixeira, Anatoliy Sokolov
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <slope/drawing_p.h>
+#include <slope/raster_p.h>
+#include <slope/workers_p.h>
+
+/* points below this are binned by a single thread */
+#define RASTER_POINTS_PER_JOB (1L << 16)
+/* cap on the memory taken by the per thread counters */
+#define RASTER_MAX_COUNTER_BYTES (64L << 20)
+/* points mapped per slope_scale_map_array() call */
+#define RASTER_MAP_CHUNK 256
+
+typedef struct _SlopeRaster
+{
+  SlopeScale *        scale;
+  const SlopeSamples *x;
+  const SlopeSamples *y;
+  const long *        runs;
+  long                n_runs;
+  cairo_matrix_t      m;
+  double              device_scale;
+  int                 px0, py0;
+  int                 width, height;
+  guint32 **          counts;
+  guint               n_bins;
+  guint32             max_count;
+  SlopeRasterMode     mode;
+  GdkRGBA             color;
+  guint32 *           pixels;
+  int                 stride;
+} SlopeRaster;
+
+typedef struct _SlopeRasterJob
+{
+  /* positions in the runs put end to end */
+  long    k_begin, k_end;
+  guint   bin;
+  int     row_begin, row_end;
+  guint32 max_count;
+} SlopeRasterJob;
+
+static void _raster_bin_range(SlopeRaster *self, guint32 *counts, long k_begin, long k_end)
+{
+  graphene_point_t buf[RASTER_MAP_CHUNK];
+  const double    sx = self->m.xx * self->device_scale;
+  const double    ox = self->m.x0 * self->device_scale - self->px0;
+  const double    oy = self->m.y0 * self->device_scale - self->py0;
+  long            k0, k, n;
+  /* map_array only reads the scale, so every job may call it */
+  for (k0 = k_begin; k0 < k_end; k0 += n)
+    {
+      n = SLOPE_MIN(k_end - k0, RASTER_MAP_CHUNK);
+      _samples_map(self->scale, buf, self->x, self->y, k0, n);
+      for (k = 0L; k < n; ++k)
+        {
+          double fx = buf[k].x * sx + ox;
+          double fy = buf[k].y * sx + oy;
+          /* also rejects NaNs */
+          if (fx >= 0.0 && fx < self->width && fy >= 0.0 && fy < self->height)
+            {
+              counts[(long) fy * self->width + (long) fx] += 1;
+            }
+        }
+    }
+}
+
+static void _raster_bin_job(gpointer data, gpointer user_data)
+{
+  SlopeRasterJob *job  = data;
+  SlopeRaster *   self = user_data;
+  long            pos  = 0L;
+  long            r, first, n;
+  for (r = 0L; r < self->n_runs && pos < job->k_end; ++r)
+    {
+      first = self->runs[2 * r];
+      n     = self->runs[2 * r + 1] - first;
+      if (pos + n > job->k_begin)
+        {
+          _raster_bin_range(self,
+                            self->counts[job->bin],
+                            first + SLOPE_MAX(job->k_begin - pos, 0L),
+                            first + SLOPE_MIN(job->k_end - pos, n));
+        }
+      pos += n;
+    }
+}
+
+static void _raster_merge_job(gpointer data, gpointer user_data)
+{
+  SlopeRasterJob *job  = data;
+  SlopeRaster *   self = user_data;
+  long            begin = (long) job->row_begin * self->width;
+  long            end   = (long) job->row_end * self->width;
+  guint32         max_count = 0;
+  long            i;
+  guint           b;
+  for (b = 1; b < self->n_bins; ++b)
+    {
+      const guint32 *src = self->counts[b];
+      guint32 *      dst = self->counts[0];
+      for (i = begin; i < end; ++i)
+        {
+          dst[i] += src[i];
+        }
+    }
+  for (i = begin; i < end; ++i)
+    {
+      if (self->counts[0][i] > max_count) max_count = self->counts[0][i];
+    }
+  job->max_count = max_count;
+}
+
+static void _raster_color_job(gpointer data, gpointer user_data)
+{
+  SlopeRasterJob *job    = data;
+  SlopeRaster *   self   = user_data;
+  const GdkRGBA * c      = &self->color;
+  double          log_max = log1p((double) self->max_count);
+  double          alpha_lut[256];
+  int             row, col, i;
+
+  if (self->mode == SLOPE_RASTER_POINTS)
+    {
+      /* coverage of n overlapping points, 1 - (1 - a)^n */
+      alpha_lut[0] = 0.0;
+      for (i = 1; i < 256; ++i)
+        {
+          alpha_lut[i] = 1.0 - (1.0 - c->alpha) * (1.0 - alpha_lut[i - 1]);
+        }
+    }
+
+  for (row = job->row_begin; row < job->row_end; ++row)
+    {
+      const guint32 *counts = self->counts[0] + (long) row * self->width;
+      guint32 *      pixels = (guint32 *) ((guint8 *) self->pixels + (long) row * self->stride);
+      for (col = 0; col < self->width; ++col)
+        {
+          guint32 count = counts[col];
+          double  a;
+          if (count == 0)
+            {
+              pixels[col] = 0;
+              continue;
+            }
+          if (self->mode == SLOPE_RASTER_POINTS)
+            a = alpha_lut[SLOPE_MIN(count, 255u)];
+          else
+            a = c->alpha * log1p((double) count) / log_max;
+          /* premultiplied, native endian ARGB32 */
+          pixels[col] = ((guint32) (a * 255.0 + 0.5) << 24) |
+                        ((guint32) (c->red * a * 255.0 + 0.5) << 16) |
+                        ((guint32) (c->green * a * 255.0 + 0.5) << 8) |
+                        ((guint32) (c->blue * a * 255.0 + 0.5));
+        }
+    }
+}
+
+gboolean _raster_draw_points(cairo_t *           cr,
+                             SlopeScale *        scale,
+                             const SlopeSamples *x,
+                             const SlopeSamples *y,
+                             const long *        runs,
+                             long                n_runs,
+                             SlopeRasterMode     mode,
+                             const GdkRGBA *     color)
+{
+  SlopeRaster      self;
+  SlopeRasterJob * jobs;
+  cairo_surface_t *image;
+  graphene_rect_t  rect;
+  double           ds, x1, y1;
+  double           clip_x1, clip_y1, clip_x2, clip_y2;
+  guint            n_jobs, n_bands, k;
+  long             area, n_pts = 0L, r;
+
+  if (_drawing_target_is_vector(cr) ||
+      !_drawing_get_pixel_transform(cr, &self.m, &ds))
+    {
+      return FALSE;
+    }
+
+  /* the counters cover the plot area of the scale in pixels. A
+   * density is relative to the most hit pixel of the whole area,
+   * plain points only need the part that is not clipped away */
+  slope_scale_get_figure_rect(scale, &rect);
+  if (mode == SLOPE_RASTER_POINTS)
+    {
+      cairo_clip_extents(cr, &clip_x1, &clip_y1, &clip_x2, &clip_y2);
+      graphene_rect_intersection(&rect,
+                                 &GRAPHENE_RECT_INIT (clip_x1,
+                                                      clip_y1,
+                                                      clip_x2 - clip_x1,
+                                                      clip_y2 - clip_y1),
+                                 &rect);
+    }
+  for (r = 0L; r < n_runs; ++r)
+    {
+      n_pts += runs[2 * r + 1] - runs[2 * r];
+    }
+  self.px0    = (int) floor((graphene_rect_get_x(&rect) * self.m.xx + self.m.x0) * ds);
+  self.py0    = (int) floor((graphene_rect_get_y(&rect) * self.m.yy + self.m.y0) * ds);
+  x1          = (graphene_rect_get_x(&rect) + graphene_rect_get_width(&rect)) * self.m.xx + self.m.x0;
+  y1          = (graphene_rect_get_y(&rect) + graphene_rect_get_height(&rect)) * self.m.yy + self.m.y0;
+  self.width  = (int) ceil(x1 * ds) - self.px0;
+  self.height = (int) ceil(y1 * ds) - self.py0;
+  if (self.width <= 0 || self.height <= 0 || n_pts <= 0L)
+    {
+      return TRUE;
+    }
+  area              = (long) self.width * self.height;
+  self.scale        = scale;
+  self.x            = x;
+  self.y            = y;
+  self.runs         = runs;
+  self.n_runs       = n_runs;
+  self.device_scale = ds;
+  self.mode         = mode;
+  self.color        = *color;
+
+  /* one counter buffer per binning job, as many jobs as the point
+   * count and the memory cap allow */
+  n_jobs = (guint) SLOPE_MIN((long) _workers_get_n_threads(),
+                             SLOPE_MAX(n_pts / RASTER_POINTS_PER_JOB, 1L));
+  n_jobs = (guint) SLOPE_MAX(1L, SLOPE_MIN((long) n_jobs,
+                                           RASTER_MAX_COUNTER_BYTES / (area * 4L)));
+  n_bands     = SLOPE_MIN(_workers_get_n_threads(), (guint) self.height);
+  self.n_bins = n_jobs;
+  self.counts = g_new(guint32 *, n_jobs);
+  jobs        = g_new0(SlopeRasterJob, SLOPE_MAX(n_jobs, n_bands));
+  for (k = 0; k < n_jobs; ++k)
+    {
+      self.counts[k]  = g_new0(guint32, area);
+      jobs[k].bin     = k;
+      jobs[k].k_begin = n_pts * k / n_jobs;
+      jobs[k].k_end   = n_pts * (k + 1) / n_jobs;
+    }
+  _workers_run(_raster_bin_job, jobs, sizeof(SlopeRasterJob), n_jobs, &self);
+
+  /* sum the counters and color the pixels by bands of rows */
+  for (k = 0; k < n_bands; ++k)
+    {
+      jobs[k].row_begin = self.height * k / n_bands;
+      jobs[k].row_end   = self.height * (k + 1) / n_bands;
+    }
+  _workers_run(_raster_merge_job, jobs, sizeof(SlopeRasterJob), n_bands, &self);
+  self.max_count = 0;
+  for (k = 0; k < n_bands; ++k)
+    {
+      self.max_count = SLOPE_MAX(self.max_count, jobs[k].max_count);
+    }
+
+  image       = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, self.width, self.height);
+  self.pixels = (guint32 *) cairo_image_surface_get_data(image);
+  self.stride = cairo_image_surface_get_stride(image);
+  cairo_surface_flush(image);
+  _workers_run(_raster_color_job, jobs, sizeof(SlopeRasterJob), n_bands, &self);
+  cairo_surface_mark_dirty(image);
+  cairo_surface_set_device_scale(image, ds, ds);
+
+  /* one paint for the whole cloud, in device space so image
+   * pixels land on target pixels */
+  cairo_save(cr);
+  cairo_identity_matrix(cr);
+  cairo_set_source_surface(cr, image, self.px0 / ds, self.py0 / ds);
+  cairo_rectangle(cr, self.px0 / ds, self.py0 / ds, self.width / ds, self.height / ds);
+  cairo_fill(cr);
+  cairo_restore(cr);
+
+  cairo_surface_destroy(image);
+  for (k = 0; k < n_jobs; ++k)
+    {
+      g_free(self.counts[k]);
+    }
+  g_free(self.counts);
+  g_free(jobs);
+  return TRUE;
+}
+
+/* slope/raster.c */
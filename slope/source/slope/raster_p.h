@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2017,2023  Elvis Teixeira, Anatoliy Sokolov
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SLOPE_RASTER_P_H
+#define SLOPE_RASTER_P_H
+
+#include <slope/samples_p.h>
+
+/* Direct to pixel scatter rendering for very large point clouds.
+ * Points are binned into per thread hit counters covering the
+ * scale's plot area, the counters are summed and turned into an
+ * ARGB32 image that is composited with a single paint. */
+typedef enum _SlopeRasterMode {
+  /* every hit pixel gets the colour, repeated hits accumulate
+   * its alpha as if the points were painted on top of each other */
+  SLOPE_RASTER_POINTS,
+  /* the colour's alpha follows log(hits) relative to the most hit
+   * pixel */
+  SLOPE_RASTER_DENSITY
+} SlopeRasterMode;
+
+/* Draws the samples of x and y in the n_runs ranges
+ * [runs[2 * r], runs[2 * r + 1]). Plain points are only binned
+ * for the part of the plot area inside the clip. Returns FALSE,
+ * without drawing, if cr is a vector target or its transform is
+ * not a plain scale and translation. */
+gboolean _raster_draw_points(cairo_t *           cr,
+                             SlopeScale *        scale,
+                             const SlopeSamples *x,
+                             const SlopeSamples *y,
+                             const long *        runs,
+                             long                n_runs,
+                             SlopeRasterMode     mode,
+                             const GdkRGBA *     color);
+
+#endif /* SLOPE_RASTER_P_H */
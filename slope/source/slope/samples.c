@@ -0,0 +1,230 @@
+/*
+ * Copyright (C) 2017,2023  Elvis Teixeira, Anatoliy Sokolov
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <slope/samples_p.h>
+#include <slope/workers_p.h>
+
+/* above this many samples the bounds of converted data are split
+ * among the workers, each job getting at least SAMPLES_JOB_PTS */
+#define SAMPLES_PARALLEL_PTS (1L << 21)
+#define SAMPLES_JOB_PTS      (1L << 20)
+
+/* the conversion loop of one sample type */
+#define SAMPLES_CONVERT(ctype)                                   \
+  do                                                             \
+    {                                                            \
+      const ctype *raw = (const ctype *) self->data + first_pt;  \
+      for (k = 0L; k < n_pts; ++k)                               \
+        {                                                        \
+          buf[k] = raw[k] * self->scale + self->offset;          \
+        }                                                        \
+    }                                                            \
+  while (0)
+
+typedef struct _SlopeSamplesJob
+{
+  SlopeBounds bounds;
+  long        k_begin, k_end;
+} SlopeSamplesJob;
+
+typedef struct _SlopeSamplesPair
+{
+  const SlopeSamples *x;
+  const SlopeSamples *y;
+} SlopeSamplesPair;
+
+void _samples_init(SlopeSamples *  self,
+                   gconstpointer   data,
+                   SlopeSampleType type,
+                   double          scale,
+                   double          offset)
+{
+  self->data   = data;
+  self->type   = type;
+  self->scale  = scale;
+  self->offset = offset;
+}
+
+gboolean _samples_equal(const SlopeSamples *a, const SlopeSamples *b)
+{
+  return a->data == b->data && a->type == b->type
+         && a->scale == b->scale && a->offset == b->offset;
+}
+
+static gboolean _samples_is_direct(const SlopeSamples *self)
+{
+  return self->type == SLOPE_SAMPLE_DOUBLE && self->scale == 1.0
+         && self->offset == 0.0;
+}
+
+double _samples_get(const SlopeSamples *self, long k)
+{
+  double raw;
+  switch (self->type)
+    {
+    case SLOPE_SAMPLE_FLOAT:
+      raw = ((const float *) self->data)[k];
+      break;
+    case SLOPE_SAMPLE_INT16:
+      raw = ((const gint16 *) self->data)[k];
+      break;
+    case SLOPE_SAMPLE_INT32:
+      raw = ((const gint32 *) self->data)[k];
+      break;
+    default:
+      raw = ((const double *) self->data)[k];
+      break;
+    }
+  return raw * self->scale + self->offset;
+}
+
+const double *_samples_read(const SlopeSamples *self,
+                            long                first_pt,
+                            long                n_pts,
+                            double *            buf)
+{
+  long k;
+  if (_samples_is_direct(self))
+    {
+      return (const double *) self->data + first_pt;
+    }
+  switch (self->type)
+    {
+    case SLOPE_SAMPLE_FLOAT:
+      SAMPLES_CONVERT(float);
+      break;
+    case SLOPE_SAMPLE_INT16:
+      SAMPLES_CONVERT(gint16);
+      break;
+    case SLOPE_SAMPLE_INT32:
+      SAMPLES_CONVERT(gint32);
+      break;
+    default:
+      SAMPLES_CONVERT(double);
+      break;
+    }
+  return buf;
+}
+
+void _samples_map(SlopeScale *        scale,
+                  graphene_point_t *  res,
+                  const SlopeSamples *x,
+                  const SlopeSamples *y,
+                  long                first_pt,
+                  long                n_pts)
+{
+  double x_buf[SAMPLES_CHUNK];
+  double y_buf[SAMPLES_CHUNK];
+  long   k0, n;
+  if (_samples_is_direct(x) && _samples_is_direct(y))
+    {
+      slope_scale_map_array(scale,
+                            res,
+                            (const double *) x->data + first_pt,
+                            (const double *) y->data + first_pt,
+                            n_pts);
+      return;
+    }
+  for (k0 = 0L; k0 < n_pts; k0 += n)
+    {
+      n = SLOPE_MIN(n_pts - k0, SAMPLES_CHUNK);
+      slope_scale_map_array(scale,
+                            res + k0,
+                            _samples_read(x, first_pt + k0, n, x_buf),
+                            _samples_read(y, first_pt + k0, n, y_buf),
+                            n);
+    }
+}
+
+static void _samples_bounds_range(SlopeBounds *       b,
+                                  const SlopeSamples *x,
+                                  const SlopeSamples *y,
+                                  long                k_begin,
+                                  long                k_end)
+{
+  double x_buf[SAMPLES_CHUNK];
+  double y_buf[SAMPLES_CHUNK];
+  long   k0, n, lead;
+  for (k0 = k_begin; k0 < k_end; k0 += n)
+    {
+      /* the sample before the chunk is converted along, for the
+       * ordering check of the chunk's first one */
+      lead = (k0 > 0L) ? 1L : 0L;
+      n    = SLOPE_MIN(k_end - k0, SAMPLES_CHUNK - lead);
+      _simd_bounds_scan(b,
+                        _samples_read(x, k0 - lead, n + lead, x_buf),
+                        _samples_read(y, k0 - lead, n + lead, y_buf),
+                        lead,
+                        n + lead);
+    }
+}
+
+static void _samples_bounds_job(gpointer job, gpointer user_data)
+{
+  SlopeSamplesJob * self = job;
+  SlopeSamplesPair *pair = user_data;
+  _simd_bounds_reset(&self->bounds);
+  _samples_bounds_range(&self->bounds, pair->x, pair->y, self->k_begin, self->k_end);
+}
+
+void _samples_bounds_scan(SlopeBounds *       b,
+                          const SlopeSamples *x,
+                          const SlopeSamples *y,
+                          long                first_pt,
+                          long                n_pts)
+{
+  SlopeSamplesJob *jobs;
+  SlopeSamplesPair pair;
+  long             n_scan = n_pts - first_pt;
+  guint            n_jobs, k;
+
+  if (_samples_is_direct(x) && _samples_is_direct(y))
+    {
+      _simd_bounds_scan(b, x->data, y->data, first_pt, n_pts);
+      return;
+    }
+  if (n_scan < SAMPLES_PARALLEL_PTS)
+    {
+      _samples_bounds_range(b, x, y, first_pt, n_pts);
+      return;
+    }
+  n_jobs = (guint) SLOPE_MIN((long) _workers_get_n_threads(),
+                             n_scan / SAMPLES_JOB_PTS);
+  jobs   = g_new(SlopeSamplesJob, n_jobs);
+  pair.x = x;
+  pair.y = y;
+  for (k = 0; k < n_jobs; ++k)
+    {
+      jobs[k].k_begin = first_pt + n_scan * k / n_jobs;
+      jobs[k].k_end   = first_pt + n_scan * (k + 1) / n_jobs;
+    }
+  _workers_run(_samples_bounds_job, jobs, sizeof(SlopeSamplesJob), n_jobs, &pair);
+  for (k = 0; k < n_jobs; ++k)
+    {
+      b->x_min    = SLOPE_MIN(b->x_min, jobs[k].bounds.x_min);
+      b->x_max    = SLOPE_MAX(b->x_max, jobs[k].bounds.x_max);
+      b->y_min    = SLOPE_MIN(b->y_min, jobs[k].bounds.y_min);
+      b->y_max    = SLOPE_MAX(b->y_max, jobs[k].bounds.y_max);
+      b->x_sorted = b->x_sorted && jobs[k].bounds.x_sorted;
+    }
+  g_free(jobs);
+}
+
+/* slope/samples.c */
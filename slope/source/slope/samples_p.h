@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2017,2023  Elvis Teixeira, Anatoliy Sokolov
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SLOPE_SAMPLES_P_H
+#define SLOPE_SAMPLES_P_H
+
+#include <slope/scale.h>
+#include <slope/simd_p.h>
+#include <slope/xyseries.h>
+
+/* One axis of a series' data, an array of any SlopeSampleType
+ * standing for the values raw * scale + offset. The readers below
+ * have a loop specialized for each type and go through small
+ * chunks, so no copy of the whole data is ever made. */
+typedef struct _SlopeSamples
+{
+  gconstpointer   data;
+  SlopeSampleType type;
+  double          scale;
+  double          offset;
+} SlopeSamples;
+
+/* most samples converted at a time */
+#define SAMPLES_CHUNK 256
+
+void _samples_init(SlopeSamples *  self,
+                   gconstpointer   data,
+                   SlopeSampleType type,
+                   double          scale,
+                   double          offset);
+
+/* TRUE for the same array read the same way */
+gboolean _samples_equal(const SlopeSamples *a, const SlopeSamples *b);
+
+double _samples_get(const SlopeSamples *self, long k);
+
+/* Values of the samples in [first_pt, first_pt + n_pts), at most
+ * SAMPLES_CHUNK of them. Plain doubles are returned in place, the
+ * other types are converted into buf */
+const double *_samples_read(const SlopeSamples *self,
+                            long                first_pt,
+                            long                n_pts,
+                            double *            buf);
+
+/* slope_scale_map_array() of the samples [first_pt, first_pt + n_pts) */
+void _samples_map(SlopeScale *        scale,
+                  graphene_point_t *  res,
+                  const SlopeSamples *x,
+                  const SlopeSamples *y,
+                  long                first_pt,
+                  long                n_pts);
+
+/* _simd_bounds_scan() of the samples [first_pt, n_pts) */
+void _samples_bounds_scan(SlopeBounds *       b,
+                          const SlopeSamples *x,
+                          const SlopeSamples *y,
+                          long                first_pt,
+                          long                n_pts);
+
+#endif /* SLOPE_SAMPLES_P_H */
@@ -18,7 +18,10 @@
  * If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
+#include <slope/figure_p.h>
 #include <slope/item_p.h>
+#include <slope/layer_p.h>
 #include <slope/scale_p.h>
 
 typedef struct _SlopeScalePrivate
@@ -35,6 +38,20 @@ typedef struct _SlopeScalePrivate
   double       name_top_padding;
   graphene_rect_t layout_rect;
   SlopeItem *  legend;
+  SlopeLayer * frame_layer;
+  /* the whole scale, when the figure draws its scales in parallel */
+  SlopeLayer * image_layer;
+  /* measures of the frame, see slope_figure_set_profiling() */
+  gboolean     profiling;
+  SlopeRenderStats stats;
+  gsize        n_mapped;
+  /* union of the data rects of the items, kept up to date by
+   * additions and recomputed after any other change, and the
+   * rescale waiting for the next draw or read of the ranges */
+  graphene_rect_t items_rect;
+  gboolean     items_rect_valid;
+  gboolean     rescale_pending;
+  int          batch_depth;
 } SlopeScalePrivate;
 
 G_DEFINE_TYPE_WITH_CODE (SlopeScale, slope_scale, G_TYPE_OBJECT, G_ADD_PRIVATE (SlopeScale))
@@ -48,6 +65,11 @@ static void _scale_finalize(GObject *self);
 static void _scale_add_item(SlopeScale *self, SlopeItem *item);
 static void _scale_clear_item_list(gpointer data);
 static void _scale_remove_item(SlopeScale *self, SlopeItem *item);
+static void _scale_map_array_impl(SlopeScale *      self,
+                                  graphene_point_t *res,
+                                  const double *    x_vec,
+                                  const double *    y_vec,
+                                  long              n_pts);
 
 static void slope_scale_class_init(SlopeScaleClass *klass)
 {
@@ -58,6 +80,7 @@ static void slope_scale_class_init(SlopeScaleClass *klass)
   klass->draw                = _scale_draw_impl;
   klass->mouse_event         = _scale_mouse_event_impl;
   klass->position_legend     = _scale_position_legend;
+  klass->map_array           = _scale_map_array_impl;
 }
 
 static void slope_scale_init(SlopeScale *self)
@@ -75,6 +98,15 @@ static void slope_scale_init(SlopeScale *self)
   priv->name_top_padding   = 0.0;
   priv->layout_rect        = GRAPHENE_RECT_INIT (0.0, 0.0, 1.0, 1.0);
   priv->legend             = slope_legend_new (GTK_ORIENTATION_VERTICAL);
+  priv->frame_layer        = _layer_new ();
+  priv->image_layer        = _layer_new ();
+  priv->profiling          = FALSE;
+  memset(&priv->stats, 0, sizeof(SlopeRenderStats));
+  priv->n_mapped           = 0;
+  priv->items_rect         = GRAPHENE_RECT_INIT (0.0, 0.0, 0.0, 0.0);
+  priv->items_rect_valid   = TRUE;
+  priv->rescale_pending    = FALSE;
+  priv->batch_depth        = 0;
 }
 
 static void _scale_finalize(GObject *self)
@@ -88,20 +120,36 @@ static void _scale_finalize(GObject *self)
       priv->item_list = NULL;
     }
   g_object_unref(priv->legend);
+  _layer_destroy(priv->frame_layer);
+  _layer_destroy(priv->image_layer);
   G_OBJECT_CLASS(slope_scale_parent_class)->finalize(self);
 }
 
 static void _scale_add_item(SlopeScale *self, SlopeItem *item)
 {
   SlopeScalePrivate *priv  = slope_scale_get_instance_private (self);
+  graphene_rect_t    item_rect;
   if (item == NULL)
     {
       return;
     }
-  priv->item_list = g_list_append(priv->item_list, item);
   slope_item_detach(item);
+  if (priv->items_rect_valid)
+    {
+      /* O(1) per item, adding n of them stays O(n) */
+      slope_item_get_data_rect (item, &item_rect);
+      if (priv->item_list == NULL)
+        {
+          priv->items_rect = item_rect;
+        }
+      else
+        {
+          graphene_rect_union (&priv->items_rect, &item_rect, &priv->items_rect);
+        }
+    }
+  priv->item_list = g_list_append(priv->item_list, item);
   _item_set_scale(item, self);
-  slope_scale_rescale(self);
+  _scale_request_rescale(self);
 }
 
 SlopeItem *slope_scale_get_item_by_name(SlopeScale *self, const char *itemname)
@@ -139,7 +187,7 @@ static void _scale_remove_item(SlopeScale *self, SlopeItem *item)
         {
           priv->item_list = g_list_delete_link(priv->item_list, iter);
           _item_set_scale(curr_item, NULL);
-          slope_scale_rescale(self);
+          _scale_data_changed(self);
         }
 
       iter = iter->next;
@@ -154,20 +202,65 @@ void slope_scale_remove_item_by_name(SlopeScale *self, const char *itemname)
 void _scale_draw(SlopeScale *self, const graphene_rect_t *rect, cairo_t *cr)
 {
   SlopeScalePrivate *priv  = slope_scale_get_instance_private (self);
-  SLOPE_SCALE_GET_CLASS(self)->draw(self, rect, cr);
+  SlopeScaleClass *  klass = SLOPE_SCALE_GET_CLASS(self);
+  gint64             begin, legend_begin;
+  priv->profiling = priv->figure != NULL && slope_figure_get_profiling(priv->figure);
+  memset(&priv->stats, 0, sizeof(SlopeRenderStats));
+  g_atomic_pointer_set(&priv->n_mapped, 0);
+  begin = _scale_stage_begin(self);
+  klass->draw(self, rect, cr);
   /* we draw the legend as the last thing to make sure it is always on top */
   if (slope_item_get_is_visible(priv->legend))
     {
-      SLOPE_SCALE_GET_CLASS(self)->position_legend(self);
+      legend_begin = _scale_stage_begin(self);
+      klass->position_legend(self);
       _scale_draw_legend(self, cr);
+      _scale_stage_end(self, SLOPE_RENDER_LEGEND, legend_begin);
+    }
+  if (klass->draw_overlay != NULL)
+    {
+      klass->draw_overlay(self, rect, cr);
+    }
+  _scale_stage_end(self, SLOPE_RENDER_SCALES, begin);
+  priv->stats.points = (gsize) g_atomic_pointer_get(&priv->n_mapped);
+}
+
+gint64 _scale_stage_begin(SlopeScale *self)
+{
+  SlopeScalePrivate *priv = slope_scale_get_instance_private (self);
+  return priv->profiling ? g_get_monotonic_time() : 0;
+}
+
+void _scale_stage_end(SlopeScale *self, SlopeRenderStage stage, gint64 begin)
+{
+  SlopeScalePrivate *priv = slope_scale_get_instance_private (self);
+  if (priv->profiling)
+    {
+      priv->stats.stage_time[stage] += g_get_monotonic_time() - begin;
     }
 }
 
+void _scale_count(SlopeScale *self, long segments, long markers)
+{
+  SlopeScalePrivate *priv = slope_scale_get_instance_private (self);
+  priv->stats.segments += segments;
+  priv->stats.markers += markers;
+}
+
+void slope_scale_get_render_stats(SlopeScale *self, SlopeRenderStats *stats)
+{
+  SlopeScalePrivate *priv = slope_scale_get_instance_private (self);
+  *stats = priv->stats;
+}
+
 void _scale_draw_impl(SlopeScale *self, const graphene_rect_t *rect, cairo_t *cr)
 {
   SlopeScalePrivate *priv = slope_scale_get_instance_private (self);
   /* TODO: break this in smaller tasks */
   GList *item_iter;
+  gboolean retained;
+  double render_scale;
+  gint64 begin;
   if (!gdk_rgba_is_clear (&priv->background_color))
     {
 
@@ -178,12 +271,25 @@ void _scale_draw_impl(SlopeScale *self, const graphene_rect_t *rect, cairo_t *cr
       cairo_fill(cr);
       cairo_restore(cr);
     }
+  retained  = _scale_get_retained(self, &render_scale);
+  begin     = _scale_stage_begin(self);
   item_iter = priv->item_list;
-  while (item_iter != NULL)
+  while (item_iter != NULL
+         && !(priv->figure != NULL && _figure_is_cancelled(priv->figure)))
     {
-      _item_draw(SLOPE_ITEM(item_iter->data), cr);
+      /* each series keeps its own image, so new data in one of
+         them does not redraw the others */
+      if (retained)
+        {
+          _item_draw_layered(SLOPE_ITEM(item_iter->data), cr, render_scale);
+        }
+      else
+        {
+          _item_draw(SLOPE_ITEM(item_iter->data), cr);
+        }
       item_iter = item_iter->next;
     }
+  _scale_stage_end(self, SLOPE_RENDER_ITEMS, begin);
   if (priv->name != NULL && priv->show_name == TRUE)
     {
       cairo_text_extents_t txt_ext;
@@ -260,11 +366,22 @@ void slope_scale_get_layout_rect (SlopeScale *self, graphene_rect_t *rect)
   graphene_rect_init_from_rect (rect, &priv->layout_rect);
 }
 
+static void _scale_set_layout_rect_call(const SlopeFigureCall *call)
+{
+  slope_scale_set_layout_rect(call->object, call->d[0], call->d[1], call->d[2], call->d[3]);
+}
+
 void slope_scale_set_layout_rect(
     SlopeScale *self, double x, double y, double w, double h)
 {
-  SlopeScalePrivate *priv  = slope_scale_get_instance_private (self);
-  graphene_rect_init (&priv->layout_rect, x, y, w, h);
+  SlopeScalePrivate *priv   = slope_scale_get_instance_private (self);
+  SlopeFigure *      figure = _figure_of_scale(self);
+  SlopeFigureCall    call   = {.object = self, .d = {x, y, w, h}};
+  if (_figure_begin_change(figure, _scale_set_layout_rect_call, &call))
+    {
+      graphene_rect_init (&priv->layout_rect, x, y, w, h);
+      _figure_end_change(figure);
+    }
 }
 
 void slope_scale_set_name(SlopeScale *self, const char *name)
@@ -289,6 +406,7 @@ void _scale_handle_mouse_event(SlopeScale *self, SlopeMouseEvent *event)
 {
   SlopeScalePrivate *priv = slope_scale_get_instance_private (self);
   GList *iter;
+  _scale_update(self);
   /* this object's own custom handling */
   SLOPE_SCALE_GET_CLASS(self)->mouse_event(self, event);
   iter = priv->item_list;
@@ -300,6 +418,16 @@ void _scale_handle_mouse_event(SlopeScale *self, SlopeMouseEvent *event)
     }
 }
 
+void _scale_sync(SlopeScale *self)
+{
+  SlopeScalePrivate *priv = slope_scale_get_instance_private (self);
+  GList *iter;
+  for (iter = priv->item_list; iter != NULL; iter = iter->next)
+    {
+      _item_sync(SLOPE_ITEM(iter->data));
+    }
+}
+
 void _scale_mouse_event_impl(SlopeScale *self, SlopeMouseEvent *event)
 {
   /* provide a place holder "do nothing" implementation */
@@ -349,10 +477,21 @@ gboolean slope_scale_get_is_visible(SlopeScale *self)
   return priv->visible;
 }
 
+static void _scale_set_is_visible_call(const SlopeFigureCall *call)
+{
+  slope_scale_set_is_visible(call->object, call->i[0]);
+}
+
 void slope_scale_set_is_visible(SlopeScale *self, gboolean visible)
 {
-  SlopeScalePrivate *priv = slope_scale_get_instance_private (self);
-  priv->visible = visible;
+  SlopeScalePrivate *priv   = slope_scale_get_instance_private (self);
+  SlopeFigure *      figure = _figure_of_scale(self);
+  SlopeFigureCall    call   = {.object = self, .i = {visible}};
+  if (_figure_begin_change(figure, _scale_set_is_visible_call, &call))
+    {
+      priv->visible = visible;
+      _figure_end_change(figure);
+    }
 }
 
 void
@@ -383,12 +522,24 @@ void slope_scale_get_figure_rect (SlopeScale *self, graphene_rect_t *rect)
 void
 slope_scale_get_data_rect(SlopeScale *self, graphene_rect_t *rect)
 {
+  _scale_update(self);
   SLOPE_SCALE_GET_CLASS(self)->get_data_rect(self, rect);
 }
 
+static void _scale_remove_item_call(const SlopeFigureCall *call)
+{
+  slope_scale_remove_item(call->object, call->keep);
+}
+
 void slope_scale_remove_item(SlopeScale *self, SlopeItem *item)
 {
-  SLOPE_SCALE_GET_CLASS(self)->remove_item(self, item);
+  SlopeFigure *   figure = _figure_of_scale(self);
+  SlopeFigureCall call   = {.object = self, .keep = item};
+  if (_figure_begin_change(figure, _scale_remove_item_call, &call))
+    {
+      SLOPE_SCALE_GET_CLASS(self)->remove_item(self, item);
+      _figure_end_change(figure);
+    }
 }
 
 GList *slope_scale_get_item_list(SlopeScale *self)
@@ -421,26 +572,185 @@ void slope_scale_set_name_top_padding(SlopeScale *self, double padding)
   priv->name_top_padding = padding;
 }
 
+static void _scale_add_item_call(const SlopeFigureCall *call)
+{
+  slope_scale_add_item(call->object, call->keep);
+}
+
 void slope_scale_add_item(SlopeScale *self, SlopeItem *item)
 {
-  SLOPE_SCALE_GET_CLASS(self)->add_item(self, item);
+  SlopeFigure *   figure = _figure_of_scale(self);
+  SlopeFigureCall call   = {.object = self, .keep = item};
+  if (_figure_begin_change(figure, _scale_add_item_call, &call))
+    {
+      SLOPE_SCALE_GET_CLASS(self)->add_item(self, item);
+      _figure_end_change(figure);
+    }
 }
 
 void
 slope_scale_map (SlopeScale *self, graphene_point_t *res, const graphene_point_t *src)
 {
+  _scale_update(self);
   SLOPE_SCALE_GET_CLASS(self)->map(self, res, src);
 }
 
 void
 slope_scale_unmap (SlopeScale *self, graphene_point_t *res, const graphene_point_t *src)
 {
+  _scale_update(self);
   SLOPE_SCALE_GET_CLASS(self)->unmap(self, res, src);
 }
 
+static void _scale_map_array_impl(SlopeScale *      self,
+                                  graphene_point_t *res,
+                                  const double *    x_vec,
+                                  const double *    y_vec,
+                                  long              n_pts)
+{
+  /* fallback for scales that only know how to map one point */
+  SlopeScaleClass *klass = SLOPE_SCALE_GET_CLASS(self);
+  graphene_point_t p;
+  long             k;
+  for (k = 0L; k < n_pts; ++k)
+    {
+      p.x = x_vec[k];
+      p.y = y_vec[k];
+      klass->map(self, &res[k], &p);
+    }
+}
+
+void slope_scale_map_array(SlopeScale *      self,
+                           graphene_point_t *res,
+                           const double *    x_vec,
+                           const double *    y_vec,
+                           long              n_pts)
+{
+  SlopeScalePrivate *priv = slope_scale_get_instance_private (self);
+  /* the raster paths map from several threads at once */
+  g_atomic_pointer_add(&priv->n_mapped, n_pts);
+  /* frames apply the rescale before drawing, so the threads
+   * mapping while drawing never find one pending */
+  _scale_update(self);
+  SLOPE_SCALE_GET_CLASS(self)->map_array(self, res, x_vec, y_vec, n_pts);
+}
+
+static void _scale_rescale_call(const SlopeFigureCall *call)
+{
+  slope_scale_rescale(call->object);
+}
+
 void slope_scale_rescale(SlopeScale *self)
 {
+  SlopeFigure *   figure = _figure_of_scale(self);
+  SlopeFigureCall call   = {.object = self};
+  if (_figure_begin_change(figure, _scale_rescale_call, &call))
+    {
+      /* the items may have changed without telling */
+      _scale_data_changed(self);
+      _figure_end_change(figure);
+    }
+}
+
+void _scale_request_rescale(SlopeScale *self)
+{
+  SlopeScalePrivate *priv = slope_scale_get_instance_private (self);
+  priv->rescale_pending = TRUE;
+}
+
+void _scale_data_changed(SlopeScale *self)
+{
+  SlopeScalePrivate *priv = slope_scale_get_instance_private (self);
+  priv->items_rect_valid = FALSE;
+  priv->rescale_pending  = TRUE;
+}
+
+void _scale_update(SlopeScale *self)
+{
+  SlopeScalePrivate *priv = slope_scale_get_instance_private (self);
+  if (!priv->rescale_pending || priv->batch_depth > 0)
+    {
+      return;
+    }
+  /* cleared first, rescale implementations set the ranges */
+  priv->rescale_pending = FALSE;
   SLOPE_SCALE_GET_CLASS(self)->rescale(self);
 }
 
+gboolean _scale_get_items_rect(SlopeScale *self, graphene_rect_t *rect)
+{
+  SlopeScalePrivate *priv = slope_scale_get_instance_private (self);
+  graphene_rect_t    item_rect;
+  GList *            iter;
+  if (priv->item_list == NULL)
+    {
+      return FALSE;
+    }
+  if (!priv->items_rect_valid)
+    {
+      slope_item_get_data_rect (SLOPE_ITEM(priv->item_list->data), &priv->items_rect);
+      for (iter = priv->item_list->next; iter != NULL; iter = iter->next)
+        {
+          slope_item_get_data_rect (SLOPE_ITEM(iter->data), &item_rect);
+          graphene_rect_union (&priv->items_rect, &item_rect, &priv->items_rect);
+        }
+      priv->items_rect_valid = TRUE;
+    }
+  *rect = priv->items_rect;
+  return TRUE;
+}
+
+void slope_scale_begin_batch(SlopeScale *self)
+{
+  SlopeScalePrivate *priv = slope_scale_get_instance_private (self);
+  priv->batch_depth += 1;
+}
+
+void slope_scale_end_batch(SlopeScale *self)
+{
+  SlopeScalePrivate *priv = slope_scale_get_instance_private (self);
+  g_return_if_fail(priv->batch_depth > 0);
+  priv->batch_depth -= 1;
+}
+
+void slope_scale_invalidate(SlopeScale *self)
+{
+  SlopeScalePrivate *priv = slope_scale_get_instance_private (self);
+  GList *            iter;
+  _layer_invalidate(priv->frame_layer);
+  for (iter = priv->item_list; iter != NULL; iter = iter->next)
+    {
+      slope_item_invalidate(SLOPE_ITEM(iter->data));
+    }
+}
+
+gboolean _scale_get_retained(SlopeScale *self, double *render_scale)
+{
+  SlopeScalePrivate *priv = slope_scale_get_instance_private (self);
+  return priv->figure != NULL && _figure_get_retained(priv->figure, render_scale);
+}
+
+void _scale_scroll(SlopeScale *self, double dx, double dy)
+{
+  SlopeScalePrivate *priv = slope_scale_get_instance_private (self);
+  GList *            iter;
+  _layer_invalidate(priv->frame_layer);
+  for (iter = priv->item_list; iter != NULL; iter = iter->next)
+    {
+      _item_scroll(SLOPE_ITEM(iter->data), dx, dy);
+    }
+}
+
+SlopeLayer *_scale_get_frame_layer(SlopeScale *self)
+{
+  SlopeScalePrivate *priv = slope_scale_get_instance_private (self);
+  return priv->frame_layer;
+}
+
+SlopeLayer *_scale_get_image_layer(SlopeScale *self)
+{
+  SlopeScalePrivate *priv = slope_scale_get_instance_private (self);
+  return priv->image_layer;
+}
+
 /* slope/scale.c */
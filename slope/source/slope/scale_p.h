@@ -21,6 +21,7 @@
 #ifndef SLOPE_SCALE_P_H
 #define SLOPE_SCALE_P_H
 
+#include <slope/layer_p.h>
 #include <slope/scale.h>
 
 void _scale_set_figure(SlopeScale *self, SlopeFigure *figure);
@@ -31,4 +32,51 @@ void _scale_handle_mouse_event(SlopeScale *self, SlopeMouseEvent *event);
 
 void _scale_mouse_event_impl(SlopeScale *self, SlopeMouseEvent *event);
 
+void _scale_sync(SlopeScale *self);
+
+/* Rescales are deferred to the next frame, or to the next use of
+ * the ranges before it, so that a burst of changes rescales once.
+ * _scale_request_rescale() fits the ranges to the items again,
+ * _scale_data_changed() also tells that the data rect of an item
+ * changed or one was removed */
+void _scale_request_rescale(SlopeScale *self);
+
+void _scale_data_changed(SlopeScale *self);
+
+/* Applies a pending rescale, unless inside a batch */
+void _scale_update(SlopeScale *self);
+
+/* Union of the data rects of the items, computed again only after
+ * _scale_data_changed(). FALSE when the scale has no items */
+gboolean _scale_get_items_rect(SlopeScale *self, graphene_rect_t *rect);
+
+/* TRUE while the scale is drawn for a view, which may then reuse
+ * the layers kept from earlier frames */
+gboolean _scale_get_retained(SlopeScale *self, double *render_scale);
+
+/* Layer for the decorations of a subclass (axes, grid, labels) that
+ * only change with the scale's ranges or geometry */
+SlopeLayer *_scale_get_frame_layer(SlopeScale *self);
+
+/* Layer the whole scale is drawn into by a worker when the figure
+ * draws its scales in parallel. It lives as long as the scale, so
+ * its image is reused while the size stays the same */
+SlopeLayer *_scale_get_image_layer(SlopeScale *self);
+
+/* For a change of ranges that moves all the data by (dx, dy) figure
+ * units, the item layers are scrolled instead of drawn again. The
+ * frame layer is always drawn again, its tick labels changed */
+void _scale_scroll(SlopeScale *self, double dx, double dy);
+
+/* Clock reading starting a stage of a profiled frame, zero when
+ * the figure is not profiled. _scale_stage_end() adds the time
+ * passed since begin to the stage of the scale */
+gint64 _scale_stage_begin(SlopeScale *self);
+
+void _scale_stage_end(SlopeScale *self, SlopeRenderStage stage, gint64 begin);
+
+/* Lets the items report the path segments and markers they drew,
+ * only from the thread drawing the scale */
+void _scale_count(SlopeScale *self, long segments, long markers);
+
 #endif /* SLOPE_SCALE_P_H */
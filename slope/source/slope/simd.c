@@ -0,0 +1,382 @@
+/*
+ * Copyright (C) 2017,2023  Elvis Teixeira, Anatoliy Sokolov
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <slope/simd_p.h>
+#include <slope/workers_p.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+/* the kernels below write two floats per point */
+G_STATIC_ASSERT(sizeof(graphene_point_t) == 2 * sizeof(float));
+
+static void _simd_affine_map_scalar(graphene_point_t *res,
+                                    const double *    x_vec,
+                                    const double *    y_vec,
+                                    long              n_pts,
+                                    double            x_scale,
+                                    double            x_offset,
+                                    double            y_scale,
+                                    double            y_offset)
+{
+  long k;
+  for (k = 0L; k < n_pts; ++k)
+    {
+      res[k].x = x_vec[k] * x_scale + x_offset;
+      res[k].y = y_vec[k] * y_scale + y_offset;
+    }
+}
+
+#ifdef SIMD_X86
+
+__attribute__((target("sse2"))) static void _simd_affine_map_sse2(
+    graphene_point_t *res,
+    const double *    x_vec,
+    const double *    y_vec,
+    long              n_pts,
+    double            x_scale,
+    double            x_offset,
+    double            y_scale,
+    double            y_offset)
+{
+  const __m128d xs = _mm_set1_pd(x_scale);
+  const __m128d xo = _mm_set1_pd(x_offset);
+  const __m128d ys = _mm_set1_pd(y_scale);
+  const __m128d yo = _mm_set1_pd(y_offset);
+  long          k  = 0L;
+  for (; k + 2L <= n_pts; k += 2L)
+    {
+      __m128d vx = _mm_add_pd(_mm_mul_pd(_mm_loadu_pd(x_vec + k), xs), xo);
+      __m128d vy = _mm_add_pd(_mm_mul_pd(_mm_loadu_pd(y_vec + k), ys), yo);
+      /* interleave {x0, x1} and {y0, y1} as x0, y0, x1, y1 */
+      __m128 xy = _mm_unpacklo_ps(_mm_cvtpd_ps(vx), _mm_cvtpd_ps(vy));
+      _mm_storeu_ps((float *) (res + k), xy);
+    }
+  _simd_affine_map_scalar(res + k,
+                          x_vec + k,
+                          y_vec + k,
+                          n_pts - k,
+                          x_scale,
+                          x_offset,
+                          y_scale,
+                          y_offset);
+}
+
+__attribute__((target("avx2"))) static void _simd_affine_map_avx2(
+    graphene_point_t *res,
+    const double *    x_vec,
+    const double *    y_vec,
+    long              n_pts,
+    double            x_scale,
+    double            x_offset,
+    double            y_scale,
+    double            y_offset)
+{
+  const __m256d xs = _mm256_set1_pd(x_scale);
+  const __m256d xo = _mm256_set1_pd(x_offset);
+  const __m256d ys = _mm256_set1_pd(y_scale);
+  const __m256d yo = _mm256_set1_pd(y_offset);
+  long          k  = 0L;
+  for (; k + 4L <= n_pts; k += 4L)
+    {
+      __m256d vx = _mm256_add_pd(_mm256_mul_pd(_mm256_loadu_pd(x_vec + k), xs), xo);
+      __m256d vy = _mm256_add_pd(_mm256_mul_pd(_mm256_loadu_pd(y_vec + k), ys), yo);
+      __m128  fx = _mm256_cvtpd_ps(vx);
+      __m128  fy = _mm256_cvtpd_ps(vy);
+      _mm_storeu_ps((float *) (res + k), _mm_unpacklo_ps(fx, fy));
+      _mm_storeu_ps((float *) (res + k + 2), _mm_unpackhi_ps(fx, fy));
+    }
+  _simd_affine_map_sse2(res + k,
+                        x_vec + k,
+                        y_vec + k,
+                        n_pts - k,
+                        x_scale,
+                        x_offset,
+                        y_scale,
+                        y_offset);
+}
+
+#endif /* SIMD_X86 */
+
+void _simd_affine_map(graphene_point_t *res,
+                      const double *    x_vec,
+                      const double *    y_vec,
+                      long              n_pts,
+                      double            x_scale,
+                      double            x_offset,
+                      double            y_scale,
+                      double            y_offset)
+{
+#ifdef SIMD_X86
+  if (__builtin_cpu_supports("avx2"))
+    {
+      _simd_affine_map_avx2(
+          res, x_vec, y_vec, n_pts, x_scale, x_offset, y_scale, y_offset);
+      return;
+    }
+  if (__builtin_cpu_supports("sse2"))
+    {
+      _simd_affine_map_sse2(
+          res, x_vec, y_vec, n_pts, x_scale, x_offset, y_scale, y_offset);
+      return;
+    }
+#endif
+  _simd_affine_map_scalar(
+      res, x_vec, y_vec, n_pts, x_scale, x_offset, y_scale, y_offset);
+}
+
+/* above this many samples the bounds scan is split among the
+ * workers, each job getting at least SIMD_BOUNDS_JOB_PTS */
+#define SIMD_BOUNDS_PARALLEL_PTS (1L << 21)
+#define SIMD_BOUNDS_JOB_PTS      (1L << 20)
+
+typedef struct _SlopeBoundsJob
+{
+  SlopeBounds bounds;
+  long        k_begin, k_end;
+} SlopeBoundsJob;
+
+/* The kernels widen b with the samples in [k_begin, k_end),
+ * k_begin >= 1, checking each x against the one before it. The
+ * comparisons are written so that NaN never widens the bounds and
+ * always breaks the ordering. */
+static void _simd_bounds_scalar(SlopeBounds * b,
+                                const double *x_vec,
+                                const double *y_vec,
+                                long          k_begin,
+                                long          k_end)
+{
+  long k;
+  for (k = k_begin; k < k_end; ++k)
+    {
+      if (!(x_vec[k] >= x_vec[k - 1])) b->x_sorted = FALSE;
+      if (x_vec[k] < b->x_min) b->x_min = x_vec[k];
+      if (x_vec[k] > b->x_max) b->x_max = x_vec[k];
+      if (y_vec[k] < b->y_min) b->y_min = y_vec[k];
+      if (y_vec[k] > b->y_max) b->y_max = y_vec[k];
+    }
+}
+
+#ifdef SIMD_X86
+
+/* min and max return their second operand when either one is NaN,
+ * so keeping the accumulators there skips the NaN lanes */
+__attribute__((target("sse2"))) static void _simd_bounds_sse2(
+    SlopeBounds * b,
+    const double *x_vec,
+    const double *y_vec,
+    long          k_begin,
+    long          k_end)
+{
+  __m128d x_min  = _mm_set1_pd(b->x_min);
+  __m128d x_max  = _mm_set1_pd(b->x_max);
+  __m128d y_min  = _mm_set1_pd(b->y_min);
+  __m128d y_max  = _mm_set1_pd(b->y_max);
+  __m128d sorted = _mm_cmpeq_pd(x_min, x_min);
+  double  lanes[2];
+  long    k      = k_begin;
+  for (; k + 2L <= k_end; k += 2L)
+    {
+      __m128d vx = _mm_loadu_pd(x_vec + k);
+      __m128d vy = _mm_loadu_pd(y_vec + k);
+      sorted     = _mm_and_pd(sorted, _mm_cmpge_pd(vx, _mm_loadu_pd(x_vec + k - 1)));
+      x_min      = _mm_min_pd(vx, x_min);
+      x_max      = _mm_max_pd(vx, x_max);
+      y_min      = _mm_min_pd(vy, y_min);
+      y_max      = _mm_max_pd(vy, y_max);
+    }
+  _mm_storeu_pd(lanes, x_min);
+  b->x_min = SLOPE_MIN(lanes[0], lanes[1]);
+  _mm_storeu_pd(lanes, x_max);
+  b->x_max = SLOPE_MAX(lanes[0], lanes[1]);
+  _mm_storeu_pd(lanes, y_min);
+  b->y_min = SLOPE_MIN(lanes[0], lanes[1]);
+  _mm_storeu_pd(lanes, y_max);
+  b->y_max = SLOPE_MAX(lanes[0], lanes[1]);
+  if (_mm_movemask_pd(sorted) != 0x3)
+    {
+      b->x_sorted = FALSE;
+    }
+  _simd_bounds_scalar(b, x_vec, y_vec, k, k_end);
+}
+
+__attribute__((target("avx2"))) static void _simd_bounds_avx2(
+    SlopeBounds * b,
+    const double *x_vec,
+    const double *y_vec,
+    long          k_begin,
+    long          k_end)
+{
+  __m256d x_min  = _mm256_set1_pd(b->x_min);
+  __m256d x_max  = _mm256_set1_pd(b->x_max);
+  __m256d y_min  = _mm256_set1_pd(b->y_min);
+  __m256d y_max  = _mm256_set1_pd(b->y_max);
+  __m256d sorted = _mm256_cmp_pd(x_min, x_min, _CMP_EQ_OQ);
+  double  lanes[4];
+  long    k      = k_begin;
+  for (; k + 4L <= k_end; k += 4L)
+    {
+      __m256d vx = _mm256_loadu_pd(x_vec + k);
+      __m256d vy = _mm256_loadu_pd(y_vec + k);
+      sorted     = _mm256_and_pd(
+          sorted, _mm256_cmp_pd(vx, _mm256_loadu_pd(x_vec + k - 1), _CMP_GE_OQ));
+      x_min = _mm256_min_pd(vx, x_min);
+      x_max = _mm256_max_pd(vx, x_max);
+      y_min = _mm256_min_pd(vy, y_min);
+      y_max = _mm256_max_pd(vy, y_max);
+    }
+  _mm256_storeu_pd(lanes, x_min);
+  b->x_min = SLOPE_MIN(SLOPE_MIN(lanes[0], lanes[1]), SLOPE_MIN(lanes[2], lanes[3]));
+  _mm256_storeu_pd(lanes, x_max);
+  b->x_max = SLOPE_MAX(SLOPE_MAX(lanes[0], lanes[1]), SLOPE_MAX(lanes[2], lanes[3]));
+  _mm256_storeu_pd(lanes, y_min);
+  b->y_min = SLOPE_MIN(SLOPE_MIN(lanes[0], lanes[1]), SLOPE_MIN(lanes[2], lanes[3]));
+  _mm256_storeu_pd(lanes, y_max);
+  b->y_max = SLOPE_MAX(SLOPE_MAX(lanes[0], lanes[1]), SLOPE_MAX(lanes[2], lanes[3]));
+  if (_mm256_movemask_pd(sorted) != 0xf)
+    {
+      b->x_sorted = FALSE;
+    }
+  _simd_bounds_sse2(b, x_vec, y_vec, k, k_end);
+}
+
+#endif /* SIMD_X86 */
+
+static void _simd_bounds_range(SlopeBounds * b,
+                               const double *x_vec,
+                               const double *y_vec,
+                               long          k_begin,
+                               long          k_end)
+{
+  if (k_begin == 0L && k_end > 0L)
+    {
+      /* the first sample has nothing to be ordered against */
+      if (x_vec[0] < b->x_min) b->x_min = x_vec[0];
+      if (x_vec[0] > b->x_max) b->x_max = x_vec[0];
+      if (y_vec[0] < b->y_min) b->y_min = y_vec[0];
+      if (y_vec[0] > b->y_max) b->y_max = y_vec[0];
+      k_begin = 1L;
+    }
+#ifdef SIMD_X86
+  if (__builtin_cpu_supports("avx2"))
+    {
+      _simd_bounds_avx2(b, x_vec, y_vec, k_begin, k_end);
+      return;
+    }
+  if (__builtin_cpu_supports("sse2"))
+    {
+      _simd_bounds_sse2(b, x_vec, y_vec, k_begin, k_end);
+      return;
+    }
+#endif
+  _simd_bounds_scalar(b, x_vec, y_vec, k_begin, k_end);
+}
+
+static void _simd_bounds_job(gpointer job, gpointer user_data)
+{
+  SlopeBoundsJob *self  = job;
+  const double ** vecs  = user_data;
+  _simd_bounds_reset(&self->bounds);
+  _simd_bounds_range(&self->bounds, vecs[0], vecs[1], self->k_begin, self->k_end);
+}
+
+void _simd_bounds_reset(SlopeBounds *b)
+{
+  b->x_min    = b->y_min = HUGE_VAL;
+  b->x_max    = b->y_max = -HUGE_VAL;
+  b->x_sorted = TRUE;
+}
+
+void _simd_bounds_scan(SlopeBounds * b,
+                       const double *x_vec,
+                       const double *y_vec,
+                       long          first_pt,
+                       long          n_pts)
+{
+  SlopeBoundsJob *jobs;
+  const double *  vecs[2];
+  long            n_scan = n_pts - first_pt;
+  guint           n_jobs, k;
+
+  if (n_scan < SIMD_BOUNDS_PARALLEL_PTS)
+    {
+      _simd_bounds_range(b, x_vec, y_vec, first_pt, n_pts);
+      return;
+    }
+  /* the slices share no samples, the first x of each one is
+   * still checked against the last of the previous one */
+  n_jobs  = (guint) SLOPE_MIN((long) _workers_get_n_threads(),
+                              n_scan / SIMD_BOUNDS_JOB_PTS);
+  jobs    = g_new(SlopeBoundsJob, n_jobs);
+  vecs[0] = x_vec;
+  vecs[1] = y_vec;
+  for (k = 0; k < n_jobs; ++k)
+    {
+      jobs[k].k_begin = first_pt + n_scan * k / n_jobs;
+      jobs[k].k_end   = first_pt + n_scan * (k + 1) / n_jobs;
+    }
+  _workers_run(_simd_bounds_job, jobs, sizeof(SlopeBoundsJob), n_jobs, vecs);
+  for (k = 0; k < n_jobs; ++k)
+    {
+      b->x_min    = SLOPE_MIN(b->x_min, jobs[k].bounds.x_min);
+      b->x_max    = SLOPE_MAX(b->x_max, jobs[k].bounds.x_max);
+      b->y_min    = SLOPE_MIN(b->y_min, jobs[k].bounds.y_min);
+      b->y_max    = SLOPE_MAX(b->y_max, jobs[k].bounds.y_max);
+      b->x_sorted = b->x_sorted && jobs[k].bounds.x_sorted;
+    }
+  g_free(jobs);
+}
+
+void _simd_bounds_finish(const SlopeBounds *b,
+                         double *           x_min,
+                         double *           x_max,
+                         double *           y_min,
+                         double *           y_max,
+                         gboolean *         x_sorted)
+{
+  /* an axis without a single number gets an empty range at 0 */
+  gboolean x_found = (b->x_min <= b->x_max);
+  gboolean y_found = (b->y_min <= b->y_max);
+  *x_min    = x_found ? b->x_min : 0.0;
+  *x_max    = x_found ? b->x_max : 0.0;
+  *y_min    = y_found ? b->y_min : 0.0;
+  *y_max    = y_found ? b->y_max : 0.0;
+  *x_sorted = b->x_sorted;
+}
+
+void _simd_bounds(const double *x_vec,
+                  const double *y_vec,
+                  long          n_pts,
+                  double *      x_min,
+                  double *      x_max,
+                  double *      y_min,
+                  double *      y_max,
+                  gboolean *    x_sorted)
+{
+  SlopeBounds b;
+  _simd_bounds_reset(&b);
+  _simd_bounds_scan(&b, x_vec, y_vec, 0L, n_pts);
+  _simd_bounds_finish(&b, x_min, x_max, y_min, y_max, x_sorted);
+}
+
+/* slope/simd.c */
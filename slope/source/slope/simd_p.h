@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2017,2023  Elvis Teixeira, Anatoliy Sokolov
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SLOPE_SIMD_P_H
+#define SLOPE_SIMD_P_H
+
+#include <slope/drawing.h>
+
+/* Vectorized kernels for the hot loops. Each one picks the best
+ * implementation for the running CPU (AVX2, SSE2 or plain C). */
+
+void _simd_affine_map(graphene_point_t *res,
+                      const double *    x_vec,
+                      const double *    y_vec,
+                      long              n_pts,
+                      double            x_scale,
+                      double            x_offset,
+                      double            y_scale,
+                      double            y_offset);
+
+/* Running bounds of a sample scan, empty after _simd_bounds_reset() */
+typedef struct _SlopeBounds
+{
+  double   x_min, x_max;
+  double   y_min, y_max;
+  gboolean x_sorted;
+} SlopeBounds;
+
+void _simd_bounds_reset(SlopeBounds *b);
+
+/* Widens b with the samples in [first_pt, n_pts), checking each x
+ * against the one before it. NaN samples are skipped but break the
+ * ordering. Big scans are split among the workers. */
+void _simd_bounds_scan(SlopeBounds * b,
+                       const double *x_vec,
+                       const double *y_vec,
+                       long          first_pt,
+                       long          n_pts);
+
+/* Reads b out, an axis with no numbers in it reads as all zero */
+void _simd_bounds_finish(const SlopeBounds *b,
+                         double *           x_min,
+                         double *           x_max,
+                         double *           y_min,
+                         double *           y_max,
+                         gboolean *         x_sorted);
+
+/* Smallest and largest x and y of n_pts samples and whether x
+ * never decreases, NaN skipped and all zero for no samples */
+void _simd_bounds(const double *x_vec,
+                  const double *y_vec,
+                  long          n_pts,
+                  double *      x_min,
+                  double *      x_max,
+                  double *      y_min,
+                  double *      y_max,
+                  gboolean *    x_sorted);
+
+#endif /* SLOPE_SIMD_P_H */
@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2017,2023  Elvis Teixeira, Anatoliy Sokolov
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <slope/drawing_p.h>
+#include <slope/stamp_p.h>
+
+typedef struct _SlopeStampKey
+{
+  SlopeStampShape shape;
+  double          radius;
+  double          stroke_width;
+  GdkRGBA         stroke_color;
+  GdkRGBA         fill_color;
+  gboolean        antialias;
+  double          pixel_scale;
+} SlopeStampKey;
+
+struct _SlopeStamp
+{
+  SlopeStampKey    key;
+  cairo_surface_t *surface;
+  cairo_pattern_t *pattern;
+  /* distance from the marker center to the stamp's top left */
+  double           extent;
+  /* user to pixel transform of the current target */
+  double           scale;
+  double           x0, y0;
+  double           pixel_scale;
+};
+
+SlopeStamp *_stamp_new(void)
+{
+  return g_new0(SlopeStamp, 1);
+}
+
+void _stamp_destroy(SlopeStamp *self)
+{
+  if (self == NULL)
+    {
+      return;
+    }
+  if (self->pattern != NULL)
+    {
+      cairo_pattern_destroy(self->pattern);
+    }
+  if (self->surface != NULL)
+    {
+      cairo_surface_destroy(self->surface);
+    }
+  g_free(self);
+}
+
+static gboolean _stamp_key_equal(const SlopeStampKey *a, const SlopeStampKey *b)
+{
+  return a->shape == b->shape && a->radius == b->radius &&
+         a->stroke_width == b->stroke_width &&
+         gdk_rgba_equal(&a->stroke_color, &b->stroke_color) &&
+         gdk_rgba_equal(&a->fill_color, &b->fill_color) &&
+         a->antialias == b->antialias && a->pixel_scale == b->pixel_scale;
+}
+
+static void _stamp_render(SlopeStamp *self, cairo_t *target)
+{
+  const SlopeStampKey *key = &self->key;
+  cairo_t *            cr;
+  int                  size;
+
+  if (self->pattern != NULL)
+    {
+      cairo_pattern_destroy(self->pattern);
+    }
+  if (self->surface != NULL)
+    {
+      cairo_surface_destroy(self->surface);
+    }
+  /* one spare pixel around the marker for antialiasing */
+  self->extent  = key->radius + 0.5 * key->stroke_width + 1.0;
+  size          = (int) ceil(2.0 * self->extent * key->pixel_scale);
+  self->surface = cairo_surface_create_similar_image(
+      cairo_get_target(target), CAIRO_FORMAT_ARGB32, size, size);
+  cairo_surface_set_device_scale(
+      self->surface, key->pixel_scale, key->pixel_scale);
+
+  cr = cairo_create(self->surface);
+  slope_cairo_set_antialias(cr, key->antialias);
+  cairo_set_line_width(cr, key->stroke_width);
+  if (key->shape == SLOPE_STAMP_SQUARE)
+    {
+      cairo_rectangle(cr,
+                      self->extent - key->radius,
+                      self->extent - key->radius,
+                      2.0 * key->radius,
+                      2.0 * key->radius);
+    }
+  else
+    {
+      slope_cairo_circle(
+          cr, &GRAPHENE_POINT_INIT (self->extent, self->extent), key->radius);
+    }
+  slope_cairo_draw(cr, &key->stroke_color, &key->fill_color);
+  cairo_destroy(cr);
+  cairo_surface_flush(self->surface);
+
+  self->pattern = cairo_pattern_create_for_surface(self->surface);
+}
+
+gboolean _stamp_begin(SlopeStamp *     self,
+                      cairo_t *        cr,
+                      SlopeStampShape  shape,
+                      double           radius,
+                      double           stroke_width,
+                      const GdkRGBA *  stroke_color,
+                      const GdkRGBA *  fill_color,
+                      gboolean         antialias)
+{
+  SlopeStampKey  key;
+  cairo_matrix_t m;
+  double         dev_sx;
+
+  if (_drawing_target_is_vector(cr) ||
+      !_drawing_get_pixel_transform(cr, &m, &dev_sx))
+    {
+      return FALSE;
+    }
+
+  key.shape        = shape;
+  key.radius       = radius;
+  key.stroke_width = stroke_width;
+  key.stroke_color = *stroke_color;
+  key.fill_color   = *fill_color;
+  key.antialias    = antialias;
+  key.pixel_scale  = m.xx * dev_sx;
+  if (self->surface == NULL || !_stamp_key_equal(&self->key, &key))
+    {
+      self->key = key;
+      _stamp_render(self, cr);
+    }
+
+  /* blit in device space so every stamp lands on whole pixels */
+  self->scale       = m.xx;
+  self->x0          = m.x0;
+  self->y0          = m.y0;
+  self->pixel_scale = dev_sx;
+  cairo_save(cr);
+  cairo_identity_matrix(cr);
+  cairo_new_path(cr);
+  return TRUE;
+}
+
+void _stamp_draw(SlopeStamp *self, cairo_t *cr, const graphene_point_t *p)
+{
+  cairo_matrix_t m;
+  double         size = 2.0 * self->extent * self->scale;
+  double         x, y;
+  /* top left corner in device units, rounded to a pixel */
+  x = round(((p->x - self->extent) * self->scale + self->x0) * self->pixel_scale)
+      / self->pixel_scale;
+  y = round(((p->y - self->extent) * self->scale + self->y0) * self->pixel_scale)
+      / self->pixel_scale;
+  cairo_matrix_init_scale(&m, 1.0 / self->scale, 1.0 / self->scale);
+  cairo_matrix_translate(&m, -x, -y);
+  cairo_pattern_set_matrix(self->pattern, &m);
+  cairo_set_source(cr, self->pattern);
+  cairo_rectangle(cr, x, y, size, size);
+  cairo_fill(cr);
+}
+
+void _stamp_end(SlopeStamp *self, cairo_t *cr)
+{
+  SLOPE_UNUSED(self);
+  cairo_restore(cr);
+}
+
+/* slope/stamp.c */
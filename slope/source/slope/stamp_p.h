@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2017,2023  Elvis Teixeira, Anatoliy Sokolov
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SLOPE_STAMP_P_H
+#define SLOPE_STAMP_P_H
+
+#include <slope/drawing.h>
+
+/* Marker cache for scatter plots. The marker is rasterised once in
+ * a small image surface at the target's pixel density and blitted,
+ * pixel snapped, at every point instead of building and filling a
+ * path per point. */
+typedef enum _SlopeStampShape {
+  SLOPE_STAMP_CIRCLE,
+  SLOPE_STAMP_SQUARE
+} SlopeStampShape;
+
+typedef struct _SlopeStamp SlopeStamp;
+
+SlopeStamp *_stamp_new(void);
+
+void _stamp_destroy(SlopeStamp *self);
+
+/* Prepares the marker for drawing on cr, re-rasterising it only
+ * when the look or the pixel density changed. Returns FALSE if cr
+ * can not take stamps (vector target or rotated transform) and the
+ * markers must be drawn as paths. */
+gboolean _stamp_begin(SlopeStamp *     self,
+                      cairo_t *        cr,
+                      SlopeStampShape  shape,
+                      double           radius,
+                      double           stroke_width,
+                      const GdkRGBA *  stroke_color,
+                      const GdkRGBA *  fill_color,
+                      gboolean         antialias);
+
+void _stamp_draw(SlopeStamp *self, cairo_t *cr, const graphene_point_t *p);
+
+void _stamp_end(SlopeStamp *self, cairo_t *cr);
+
+#endif /* SLOPE_STAMP_P_H */
@@ -0,0 +1,501 @@
+/*
+ * Copyright (C) 2017,2023  Elvis Teixeira, Anatoliy Sokolov
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <slope/decimator_p.h>
+#include <slope/figure_p.h>
+#include <slope/item_p.h>
+#include <slope/scale_p.h>
+#include <slope/streamseries.h>
+
+/* ring slots summarised by each bounds block */
+#define STREAM_BLOCK 256L
+/* points mapped per slope_scale_map_array() call while drawing */
+#define STREAM_MAP_CHUNK 256L
+
+typedef struct _SlopeStreamBounds
+{
+  double x_min, x_max;
+  double y_min, y_max;
+} SlopeStreamBounds;
+
+typedef struct _SlopeStreamSeriesPrivate
+{
+  double *           x_buf;
+  double *           y_buf;
+  long               capacity;
+  long               head;
+  long               n_pts;
+  SlopeStreamBounds *blocks;
+  long               n_blocks;
+  SlopeStreamBounds  filling;
+  SlopeStreamBounds  bounds;
+  /* single producer / single consumer queue, the producer only
+   * moves q_tail and the main thread only moves q_head */
+  double *           q_x;
+  double *           q_y;
+  guint              q_mask;
+  gint               q_head;
+  gint               q_tail;
+  GdkRGBA            line_color;
+  double             line_width;
+  gboolean           antialias;
+} SlopeStreamSeriesPrivate;
+
+static void _streamseries_draw(SlopeItem *self, cairo_t *cr);
+static void _streamseries_draw_thumb (SlopeItem *       self,
+                                      cairo_t *         cr,
+                                      const graphene_point_t *pos);
+static void _streamseries_finalize(GObject *self);
+static void _streamseries_get_figure_rect (SlopeItem *self, graphene_rect_t *rect);
+static void _streamseries_get_data_rect (SlopeItem *self, graphene_rect_t *rect);
+static void _streamseries_push_segment(SlopeStreamSeries *self,
+                                       SlopeDecimator *   decimator,
+                                       long               k_begin,
+                                       long               k_end);
+static void _streamseries_write(SlopeStreamSeries *self,
+                                const double *     x_vec,
+                                const double *     y_vec,
+                                long               n_pts);
+static void _streamseries_update_bounds(SlopeStreamSeries *self);
+static void _streamseries_sync(SlopeItem *self);
+
+G_DEFINE_TYPE_WITH_CODE (SlopeStreamSeries, slope_streamseries, SLOPE_ITEM_TYPE, G_ADD_PRIVATE (SlopeStreamSeries))
+
+static void slope_streamseries_class_init(SlopeStreamSeriesClass *klass)
+{
+  GObjectClass *  object_klass = G_OBJECT_CLASS(klass);
+  SlopeItemClass *item_klass   = SLOPE_ITEM_CLASS(klass);
+  object_klass->finalize       = _streamseries_finalize;
+  item_klass->draw             = _streamseries_draw;
+  item_klass->draw_thumb       = _streamseries_draw_thumb;
+  item_klass->get_data_rect    = _streamseries_get_data_rect;
+  item_klass->get_figure_rect  = _streamseries_get_figure_rect;
+  item_klass->sync             = _streamseries_sync;
+}
+
+static void _streamseries_bounds_clear(SlopeStreamBounds *b)
+{
+  b->x_min = b->y_min = G_MAXDOUBLE;
+  b->x_max = b->y_max = -G_MAXDOUBLE;
+}
+
+static void _streamseries_bounds_add(SlopeStreamBounds *b, double x, double y)
+{
+  /* NaNs fail every comparison and are left out */
+  if (x < b->x_min) b->x_min = x;
+  if (x > b->x_max) b->x_max = x;
+  if (y < b->y_min) b->y_min = y;
+  if (y > b->y_max) b->y_max = y;
+}
+
+static void _streamseries_bounds_merge(SlopeStreamBounds *      b,
+                                       const SlopeStreamBounds *other)
+{
+  if (other->x_min < b->x_min) b->x_min = other->x_min;
+  if (other->x_max > b->x_max) b->x_max = other->x_max;
+  if (other->y_min < b->y_min) b->y_min = other->y_min;
+  if (other->y_max > b->y_max) b->y_max = other->y_max;
+}
+
+static void slope_streamseries_init(SlopeStreamSeries *self)
+{
+  SlopeStreamSeriesPrivate *priv = slope_streamseries_get_instance_private (self);
+  priv->x_buf       = NULL;
+  priv->y_buf       = NULL;
+  priv->capacity    = 0L;
+  priv->head        = 0L;
+  priv->n_pts       = 0L;
+  priv->blocks      = NULL;
+  priv->n_blocks    = 0L;
+  priv->q_x         = NULL;
+  priv->q_y         = NULL;
+  priv->q_mask      = 0;
+  priv->q_head      = 0;
+  priv->q_tail      = 0;
+  _streamseries_bounds_clear(&priv->filling);
+  _streamseries_bounds_clear(&priv->bounds);
+  gdk_rgba_parse (&priv->line_color, "blue");
+  priv->line_width  = 1.5;
+  priv->antialias   = TRUE;
+}
+
+static void _streamseries_finalize(GObject *self)
+{
+  SlopeStreamSeriesPrivate *priv = slope_streamseries_get_instance_private (SLOPE_STREAMSERIES (self));
+  g_free(priv->x_buf);
+  g_free(priv->y_buf);
+  g_free(priv->blocks);
+  g_free(priv->q_x);
+  g_free(priv->q_y);
+  G_OBJECT_CLASS(slope_streamseries_parent_class)->finalize(self);
+}
+
+SlopeItem *slope_streamseries_new(long capacity)
+{
+  SlopeStreamSeries *       self = SLOPE_STREAMSERIES(g_object_new(SLOPE_STREAMSERIES_TYPE, NULL));
+  SlopeStreamSeriesPrivate *priv = slope_streamseries_get_instance_private (self);
+  guint                     q_size = 1;
+  /* the ring never keeps more than capacity samples, so queueing
+   * more than that between two frames would be useless */
+  priv->capacity = CLAMP(capacity, 1L, (long) G_MAXINT / 2);
+  while (q_size < (guint) priv->capacity)
+    {
+      q_size <<= 1;
+    }
+  priv->q_x      = g_new(double, q_size);
+  priv->q_y      = g_new(double, q_size);
+  priv->q_mask   = q_size - 1;
+  priv->x_buf    = g_new(double, priv->capacity);
+  priv->y_buf    = g_new(double, priv->capacity);
+  priv->n_blocks = (priv->capacity + STREAM_BLOCK - 1) / STREAM_BLOCK;
+  priv->blocks   = g_new(SlopeStreamBounds, priv->n_blocks);
+  slope_streamseries_clear(self);
+  return SLOPE_ITEM(self);
+}
+
+static void _streamseries_clear_call(const SlopeFigureCall *call)
+{
+  slope_streamseries_clear(call->object);
+}
+
+void slope_streamseries_clear(SlopeStreamSeries *self)
+{
+  SlopeStreamSeriesPrivate *priv   = slope_streamseries_get_instance_private (self);
+  SlopeFigure *             figure = _figure_of_scale(slope_item_get_scale(SLOPE_ITEM(self)));
+  SlopeFigureCall           call   = {.object = self};
+  long                      b;
+  if (!_figure_begin_change(figure, _streamseries_clear_call, &call))
+    {
+      return;
+    }
+  priv->head  = 0L;
+  priv->n_pts = 0L;
+  for (b = 0L; b < priv->n_blocks; ++b)
+    {
+      _streamseries_bounds_clear(&priv->blocks[b]);
+    }
+  _streamseries_bounds_clear(&priv->filling);
+  _streamseries_bounds_clear(&priv->bounds);
+  /* drop what is still queued, moving q_head is the consumer's
+   * side of the queue */
+  g_atomic_int_set(&priv->q_head, g_atomic_int_get(&priv->q_tail));
+  slope_item_invalidate(SLOPE_ITEM(self));
+  _figure_end_change(figure);
+}
+
+static void _streamseries_write(SlopeStreamSeries *self,
+                                const double *     x_vec,
+                                const double *     y_vec,
+                                long               n_pts)
+{
+  SlopeStreamSeriesPrivate *priv = slope_streamseries_get_instance_private (self);
+  long                      k, b, pos, end;
+
+  if (n_pts > priv->capacity)
+    {
+      /* only the newest samples would survive anyway */
+      x_vec += n_pts - priv->capacity;
+      y_vec += n_pts - priv->capacity;
+      n_pts = priv->capacity;
+    }
+
+  pos = (priv->head + priv->n_pts) % priv->capacity;
+  for (k = 0L; k < n_pts; ++k)
+    {
+      long offset = pos % STREAM_BLOCK;
+      b = pos / STREAM_BLOCK;
+      priv->x_buf[pos] = x_vec[k];
+      priv->y_buf[pos] = y_vec[k];
+      /* filling holds the bounds of the slots of the block
+       * rewritten so far */
+      if (offset == 0L)
+        {
+          _streamseries_bounds_clear(&priv->filling);
+        }
+      _streamseries_bounds_add(&priv->filling, x_vec[k], y_vec[k]);
+      if (offset == STREAM_BLOCK - 1L || pos == priv->capacity - 1L)
+        {
+          priv->blocks[b] = priv->filling;
+        }
+      if (priv->n_pts < priv->capacity)
+        {
+          priv->n_pts += 1L;
+        }
+      else
+        {
+          priv->head = (priv->head + 1L == priv->capacity) ? 0L : priv->head + 1L;
+        }
+      pos = (pos + 1L == priv->capacity) ? 0L : pos + 1L;
+    }
+
+  /* the block left partly rewritten also holds, once the ring is
+   * full, the oldest samples still waiting to be overwritten. Those
+   * are scanned again, the evicted ones must not count */
+  if (pos % STREAM_BLOCK != 0L)
+    {
+      b               = pos / STREAM_BLOCK;
+      end             = SLOPE_MIN((b + 1L) * STREAM_BLOCK, priv->capacity);
+      priv->blocks[b] = priv->filling;
+      for (k = pos; k < end && priv->n_pts == priv->capacity; ++k)
+        {
+          _streamseries_bounds_add(&priv->blocks[b], priv->x_buf[k], priv->y_buf[k]);
+        }
+    }
+}
+
+static void _streamseries_update_bounds(SlopeStreamSeries *self)
+{
+  SlopeStreamSeriesPrivate *priv = slope_streamseries_get_instance_private (self);
+  SlopeScale *              scale = slope_item_get_scale(SLOPE_ITEM(self));
+  long                      b;
+  /* O(capacity / STREAM_BLOCK), independent of the sample count */
+  _streamseries_bounds_clear(&priv->bounds);
+  for (b = 0L; b < priv->n_blocks; ++b)
+    {
+      _streamseries_bounds_merge(&priv->bounds, &priv->blocks[b]);
+    }
+  slope_item_invalidate(SLOPE_ITEM(self));
+  if (scale != NULL)
+    {
+      _scale_data_changed(scale);
+    }
+}
+
+static void _streamseries_append_call(const SlopeFigureCall *call)
+{
+  slope_streamseries_append(call->object, call->p[0], call->p[1], call->n);
+}
+
+void slope_streamseries_append(SlopeStreamSeries *self,
+                               const double *     x_vec,
+                               const double *     y_vec,
+                               long               n_pts)
+{
+  SlopeFigure *   figure = _figure_of_scale(slope_item_get_scale(SLOPE_ITEM(self)));
+  /* the samples are copied if the call has to wait */
+  SlopeFigureCall call   = {.object = self,
+                            .p      = {(gpointer) x_vec, (gpointer) y_vec},
+                            .p_size = (n_pts > 0L) ? n_pts * sizeof(double) : 0,
+                            .n      = n_pts};
+  if (n_pts <= 0L || !_figure_begin_change(figure, _streamseries_append_call, &call))
+    {
+      return;
+    }
+  _streamseries_write(self, x_vec, y_vec, n_pts);
+  _streamseries_update_bounds(self);
+  _figure_end_change(figure);
+}
+
+long slope_streamseries_push(SlopeStreamSeries *self,
+                             const double *     x_vec,
+                             const double *     y_vec,
+                             long               n_pts)
+{
+  SlopeStreamSeriesPrivate *priv = slope_streamseries_get_instance_private (self);
+  guint                     tail = (guint) g_atomic_int_get(&priv->q_tail);
+  guint                     head = (guint) g_atomic_int_get(&priv->q_head);
+  guint                     space = priv->q_mask + 1 - (tail - head);
+  guint                     n, first;
+
+  if (n_pts <= 0L)
+    {
+      return 0L;
+    }
+  /* never wait for the consumer, what does not fit is refused */
+  n     = (guint) SLOPE_MIN((long) space, n_pts);
+  first = SLOPE_MIN(n, priv->q_mask + 1 - (tail & priv->q_mask));
+  memcpy(priv->q_x + (tail & priv->q_mask), x_vec, first * sizeof(double));
+  memcpy(priv->q_y + (tail & priv->q_mask), y_vec, first * sizeof(double));
+  memcpy(priv->q_x, x_vec + first, (n - first) * sizeof(double));
+  memcpy(priv->q_y, y_vec + first, (n - first) * sizeof(double));
+  /* publishing the new tail is a full barrier, the consumer
+   * can only see it after the samples were written */
+  g_atomic_int_set(&priv->q_tail, (gint) (tail + n));
+  if (n > 0)
+    {
+      _item_schedule_redraw(SLOPE_ITEM(self));
+    }
+  return (long) n;
+}
+
+static void _streamseries_sync(SlopeItem *self)
+{
+  SlopeStreamSeriesPrivate *priv = slope_streamseries_get_instance_private (SLOPE_STREAMSERIES (self));
+  guint                     head = (guint) g_atomic_int_get(&priv->q_head);
+  guint                     tail = (guint) g_atomic_int_get(&priv->q_tail);
+  guint                     n;
+
+  if (head == tail)
+    {
+      return;
+    }
+  while (head != tail)
+    {
+      /* at most two contiguous runs, before and after the wrap */
+      n = SLOPE_MIN(tail - head, priv->q_mask + 1 - (head & priv->q_mask));
+      _streamseries_write(SLOPE_STREAMSERIES(self),
+                          priv->q_x + (head & priv->q_mask),
+                          priv->q_y + (head & priv->q_mask),
+                          n);
+      head += n;
+    }
+  g_atomic_int_set(&priv->q_head, (gint) head);
+  _streamseries_update_bounds(SLOPE_STREAMSERIES(self));
+}
+
+long slope_streamseries_get_n_points(SlopeStreamSeries *self)
+{
+  SlopeStreamSeriesPrivate *priv = slope_streamseries_get_instance_private (self);
+  return priv->n_pts;
+}
+
+long slope_streamseries_get_capacity(SlopeStreamSeries *self)
+{
+  SlopeStreamSeriesPrivate *priv = slope_streamseries_get_instance_private (self);
+  return priv->capacity;
+}
+
+static void _streamseries_set_line_color_call(const SlopeFigureCall *call)
+{
+  slope_streamseries_set_line_color(call->object, call->p[0]);
+}
+
+void slope_streamseries_set_line_color(SlopeStreamSeries *self,
+                                       const GdkRGBA *    color)
+{
+  SlopeStreamSeriesPrivate *priv   = slope_streamseries_get_instance_private (self);
+  SlopeFigure *             figure = _figure_of_scale(slope_item_get_scale(SLOPE_ITEM(self)));
+  SlopeFigureCall           call   = {.object = self, .p = {(gpointer) color}, .p_size = sizeof(GdkRGBA)};
+  if (!_figure_begin_change(figure, _streamseries_set_line_color_call, &call))
+    {
+      return;
+    }
+  priv->line_color = *color;
+  slope_item_invalidate(SLOPE_ITEM(self));
+  _figure_end_change(figure);
+}
+
+static void _streamseries_set_line_width_call(const SlopeFigureCall *call)
+{
+  slope_streamseries_set_line_width(call->object, call->d[0]);
+}
+
+void slope_streamseries_set_line_width(SlopeStreamSeries *self,
+                                       double             width)
+{
+  SlopeStreamSeriesPrivate *priv   = slope_streamseries_get_instance_private (self);
+  SlopeFigure *             figure = _figure_of_scale(slope_item_get_scale(SLOPE_ITEM(self)));
+  SlopeFigureCall           call   = {.object = self, .d = {width}};
+  if (!_figure_begin_change(figure, _streamseries_set_line_width_call, &call))
+    {
+      return;
+    }
+  priv->line_width = width;
+  slope_item_invalidate(SLOPE_ITEM(self));
+  _figure_end_change(figure);
+}
+
+static void _streamseries_push_segment(SlopeStreamSeries *self,
+                                       SlopeDecimator *   decimator,
+                                       long               k_begin,
+                                       long               k_end)
+{
+  SlopeStreamSeriesPrivate *priv = slope_streamseries_get_instance_private (self);
+  SlopeScale *              scale = slope_item_get_scale(SLOPE_ITEM(self));
+  graphene_point_t          buf[STREAM_MAP_CHUNK];
+  long                      k0, k, n;
+  for (k0 = k_begin; k0 < k_end; k0 += n)
+    {
+      n = SLOPE_MIN(k_end - k0, STREAM_MAP_CHUNK);
+      slope_scale_map_array(scale, buf, priv->x_buf + k0, priv->y_buf + k0, n);
+      for (k = 0L; k < n; ++k)
+        {
+          _decimator_push(decimator, &buf[k]);
+        }
+    }
+}
+
+static void _streamseries_draw(SlopeItem *self, cairo_t *cr)
+{
+  SlopeStreamSeriesPrivate *priv = slope_streamseries_get_instance_private (SLOPE_STREAMSERIES (self));
+  SlopeDecimator            decimator;
+  long                      tail;
+  if (priv->n_pts == 0L)
+    {
+      return;
+    }
+  /* the ring holds at most two contiguous segments in time order,
+   * [head, capacity) followed by [0, tail) once it wrapped */
+  tail = priv->head + priv->n_pts;
+  slope_cairo_set_antialias(cr, priv->antialias);
+  cairo_new_path(cr);
+  _decimator_begin(&decimator, cr);
+  _streamseries_push_segment(SLOPE_STREAMSERIES(self),
+                             &decimator,
+                             priv->head,
+                             SLOPE_MIN(tail, priv->capacity));
+  if (tail > priv->capacity)
+    {
+      _streamseries_push_segment(
+          SLOPE_STREAMSERIES(self), &decimator, 0L, tail - priv->capacity);
+    }
+  _decimator_end(&decimator);
+  _scale_count(slope_item_get_scale(self), decimator.n_segments, 0L);
+  cairo_set_line_width(cr, priv->line_width);
+  gdk_cairo_set_source_rgba (cr, &priv->line_color);
+  cairo_stroke(cr);
+}
+
+static void
+_streamseries_draw_thumb (SlopeItem *self,
+                          cairo_t *cr,
+                          const graphene_point_t *pos)
+{
+  SlopeStreamSeriesPrivate *priv = slope_streamseries_get_instance_private (SLOPE_STREAMSERIES (self));
+  slope_cairo_set_antialias(cr, priv->antialias);
+  gdk_cairo_set_source_rgba (cr, &priv->line_color);
+  cairo_set_line_width(cr, priv->line_width);
+  cairo_move_to(cr, pos->x - 10.0, pos->y);
+  cairo_line_to(cr, pos->x + 10.0, pos->y);
+  cairo_stroke(cr);
+}
+
+static void
+_streamseries_get_figure_rect (SlopeItem *self, graphene_rect_t *rect)
+{
+  slope_scale_get_figure_rect (slope_item_get_scale (self), rect);
+}
+
+static void
+_streamseries_get_data_rect (SlopeItem *self, graphene_rect_t *rect)
+{
+  SlopeStreamSeriesPrivate *priv = slope_streamseries_get_instance_private (SLOPE_STREAMSERIES (self));
+  if (priv->bounds.x_min > priv->bounds.x_max ||
+      priv->bounds.y_min > priv->bounds.y_max)
+    {
+      graphene_rect_init (rect, 0.0, 0.0, 0.0, 0.0);
+      return;
+    }
+  graphene_rect_init (rect, priv->bounds.x_min, priv->bounds.y_min,
+                      priv->bounds.x_max - priv->bounds.x_min,
+                      priv->bounds.y_max - priv->bounds.y_min);
+}
+
+/* slope/streamseries.c */
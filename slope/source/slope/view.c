@@ -19,19 +19,71 @@
  */
 
 #include <slope/figure_p.h>
-#include <slope/view.h>
+#include <slope/view_p.h>
+
+/* a frame in flight is dropped for a newer one only while the
+   one on screen is younger than this, so a steady stream of data
+   cannot keep the view from ever updating */
+#define VIEW_MAX_FRAME_AGE (250 * G_TIME_SPAN_MILLISECOND)
 
 typedef struct _SlopeViewPrivate
 {
-  SlopeFigure *figure;
-  gboolean     mouse_pressed;
+  SlopeFigure *   figure;
+  gboolean        mouse_pressed;
+  /* work waiting for the next frame clock tick */
+  guint           tick_id;
+  gboolean        frame_pending;
+  gboolean        motion_pending;
+  SlopeMouseEvent motion_event;
+  guint64         coalesced_redraws;
+  /* async mode, the figure is drawn by a worker into frame_texture */
+  gboolean        async;
+  GTask *         render_task;
+  GCancellable *  render_cancellable;
+  GdkTexture *    frame_texture;
+  graphene_rect_t frame_bounds;
+  gint64          frame_time;
+  /* size and scale factor of the last frame asked for */
+  int             frame_width;
+  int             frame_height;
+  int             frame_scale;
+  /* presses and releases arriving while the worker owns the figure */
+  GQueue          event_queue;
 } SlopeViewPrivate;
 
+typedef struct _SlopeViewRenderJob
+{
+  SlopeFigure *figure;
+  int          width;
+  int          height;
+  int          scale;
+} SlopeViewRenderJob;
+
 G_DEFINE_TYPE_WITH_CODE (SlopeView, slope_view, GTK_TYPE_DRAWING_AREA, G_ADD_PRIVATE (SlopeView))
 
+static void _view_dispose(GObject *self);
 static void _view_finalize(GObject *self);
 static void _view_set_figure(SlopeView *self, SlopeFigure *figure);
 static void _view_snapshot (GtkWidget *self, GtkSnapshot *snapshot);
+static void _view_ensure_tick (SlopeView *self);
+static gboolean _view_tick (GtkWidget *widget,
+                            GdkFrameClock *frame_clock,
+                            gpointer user_data);
+static void _view_flush_motion (SlopeView *self);
+static void _view_handle_button_event (SlopeView *self,
+                                       SlopeMouseEvent *event);
+static void _view_defer_event (SlopeView *self,
+                               const SlopeMouseEvent *event);
+static void _view_flush_events (SlopeView *self);
+static void _view_start_render (SlopeView *self);
+static void _view_render_thread (GTask *task,
+                                 gpointer source_object,
+                                 gpointer task_data,
+                                 GCancellable *cancellable);
+static void _view_render_done (GObject *source_object,
+                               GAsyncResult *result,
+                               gpointer user_data);
+static void _view_render_job_free (gpointer data);
 static void _motion_controller_motion (GtkEventControllerMotion* controller,
                                        gdouble x, gdouble y,
                                        gpointer user_data);
@@ -43,6 +95,7 @@ static void _gesture_click_released (GtkGestureClick* self, gint n_press,
 static void slope_view_class_init(SlopeViewClass *klass)
 {
   GObjectClass *object_klass = G_OBJECT_CLASS(klass);
+  object_klass->dispose      = _view_dispose;
   object_klass->finalize     = _view_finalize;
   klass->set_figure          = _view_set_figure;
 
@@ -56,6 +109,20 @@ static void slope_view_init(SlopeView *self)
   SlopeViewPrivate *priv       = slope_view_get_instance_private (self);
   priv->figure                 = NULL;
   priv->mouse_pressed          = FALSE;
+  priv->tick_id                = 0;
+  priv->frame_pending          = FALSE;
+  priv->motion_pending         = FALSE;
+  priv->coalesced_redraws      = 0;
+  priv->async                  = FALSE;
+  priv->render_task            = NULL;
+  priv->render_cancellable     = NULL;
+  priv->frame_texture          = NULL;
+  priv->frame_bounds           = GRAPHENE_RECT_INIT (0.0, 0.0, 0.0, 0.0);
+  priv->frame_time             = 0;
+  priv->frame_width            = 0;
+  priv->frame_height           = 0;
+  priv->frame_scale            = 0;
+  g_queue_init(&priv->event_queue);
   /* minimum width and height of the widget */
   gtk_widget_set_size_request(gtk_widget, 250, 250);
 
@@ -73,9 +140,24 @@ static void slope_view_init(SlopeView *self)
   gtk_widget_add_controller (gtk_widget, GTK_EVENT_CONTROLLER (gesture_click));
 }
 
+static void _view_dispose(GObject *self)
+{
+  SlopeViewPrivate *priv = slope_view_get_instance_private (SLOPE_VIEW (self));
+  /* nobody will show the frame in flight */
+  if (priv->render_cancellable != NULL)
+    {
+      g_cancellable_cancel(priv->render_cancellable);
+    }
+  G_OBJECT_CLASS(slope_view_parent_class)->dispose(self);
+}
+
 static void _view_finalize(GObject *self)
 {
   SlopeViewPrivate *priv = slope_view_get_instance_private (SLOPE_VIEW (self));
+  /* a running worker holds its own figure reference, and the
+     completion callback its own view reference */
+  g_queue_clear_full(&priv->event_queue, g_free);
+  g_clear_object(&priv->frame_texture);
   if (priv->figure != NULL)
     {
       if (slope_figure_get_is_managed(priv->figure))
@@ -124,8 +206,31 @@ _view_snapshot (GtkWidget *self, GtkSnapshot *snapshot)
   if (!gtk_widget_compute_bounds (self, self, &out_bounds))
     return;
 
+  if (priv->async)
+    {
+      /* never wait for the worker, show the last frame it finished */
+      if (priv->frame_width != gtk_widget_get_width (self)
+          || priv->frame_height != gtk_widget_get_height (self)
+          || priv->frame_scale != gtk_widget_get_scale_factor (self))
+        {
+          _view_queue_frame (SLOPE_VIEW (self));
+        }
+      if (priv->frame_texture != NULL)
+        {
+          gtk_snapshot_append_texture (snapshot, priv->frame_texture, &priv->frame_bounds);
+        }
+      return;
+    }
+
+  slope_figure_lock (priv->figure);
+  /* take in the samples queued by producer threads */
+  _figure_sync (priv->figure);
+
   cr = gtk_snapshot_append_cairo (snapshot, &out_bounds);
+  _figure_set_retained (priv->figure, TRUE, gtk_widget_get_scale_factor (self));
   slope_figure_draw (priv->figure, &out_bounds, cr);
+  _figure_set_retained (priv->figure, FALSE, 1.0);
+  slope_figure_unlock (priv->figure);
 }
 
 static void
@@ -147,7 +252,15 @@ _motion_controller_motion (GtkEventControllerMotion* controller,
   mouse_event.x = x;
   mouse_event.y = y;
 
-  _figure_handle_mouse_event(priv->figure, &mouse_event);
+  /* only the last position before a frame matters, zoom and pan
+     work from the press point, not from the intermediate ones */
+  if (priv->motion_pending)
+    {
+      priv->coalesced_redraws++;
+    }
+  priv->motion_event   = mouse_event;
+  priv->motion_pending = TRUE;
+  _view_ensure_tick (SLOPE_VIEW (gtk_widget));
 }
 
 static void
@@ -181,7 +294,7 @@ _gesture_click_pressed (GtkGestureClick* self, gint n_press,
   mouse_event.x = x;
   mouse_event.y = y;
 
-  _figure_handle_mouse_event(priv->figure, &mouse_event);
+  _view_handle_button_event (SLOPE_VIEW (gtk_widget), &mouse_event);
 }
 
 static void
@@ -216,7 +329,7 @@ _gesture_click_released (GtkGestureClick* self, gint n_press,
   mouse_event.x = x;
   mouse_event.y = y;
 
-  _figure_handle_mouse_event(priv->figure, &mouse_event);
+  _view_handle_button_event (SLOPE_VIEW (gtk_widget), &mouse_event);
 }
 
 static void _view_set_figure(SlopeView *self, SlopeFigure *figure)
@@ -248,7 +361,268 @@ SlopeFigure *slope_view_get_figure(SlopeFigure *self)
 
 void slope_view_redraw(SlopeView *self)
 {
-  gtk_widget_queue_draw(GTK_WIDGET(self));
+  SlopeViewPrivate *priv = slope_view_get_instance_private (self);
+  /* the caller may have changed anything, draw it all again */
+  if (priv->figure != NULL)
+    {
+      _figure_invalidate(priv->figure);
+    }
+  _view_queue_frame(self);
+}
+
+void _view_queue_frame(SlopeView *self)
+{
+  SlopeViewPrivate *priv = slope_view_get_instance_private (self);
+  /* the frame being drawn is already out of date */
+  if (priv->render_task != NULL
+      && g_get_monotonic_time() - priv->frame_time < VIEW_MAX_FRAME_AGE)
+    {
+      g_cancellable_cancel(priv->render_cancellable);
+    }
+  if (priv->frame_pending)
+    {
+      priv->coalesced_redraws++;
+      return;
+    }
+  priv->frame_pending = TRUE;
+  _view_ensure_tick(self);
+}
+
+static void _view_ensure_tick(SlopeView *self)
+{
+  SlopeViewPrivate *priv = slope_view_get_instance_private (self);
+  if (priv->tick_id == 0)
+    {
+      priv->tick_id = gtk_widget_add_tick_callback(GTK_WIDGET(self), _view_tick, NULL, NULL);
+    }
+}
+
+static void _view_handle_button_event(SlopeView *self, SlopeMouseEvent *event)
+{
+  SlopeViewPrivate *priv = slope_view_get_instance_private (self);
+  if (priv->render_task != NULL)
+    {
+      /* the worker owns the figure, keep the order of the events
+         and hand them over once it is done */
+      if (priv->motion_pending)
+        {
+          priv->motion_pending = FALSE;
+          _view_defer_event(self, &priv->motion_event);
+        }
+      _view_defer_event(self, event);
+      return;
+    }
+  /* presses and releases must see the motion that came before them */
+  _view_flush_motion(self);
+  _figure_handle_mouse_event(priv->figure, event);
+}
+
+static void _view_defer_event(SlopeView *self, const SlopeMouseEvent *event)
+{
+  SlopeViewPrivate *priv = slope_view_get_instance_private (self);
+  SlopeMouseEvent * copy = g_new(SlopeMouseEvent, 1);
+  *copy = *event;
+  g_queue_push_tail(&priv->event_queue, copy);
+}
+
+static void _view_flush_events(SlopeView *self)
+{
+  SlopeViewPrivate *priv = slope_view_get_instance_private (self);
+  SlopeMouseEvent * event;
+  while ((event = g_queue_pop_head(&priv->event_queue)) != NULL)
+    {
+      _figure_handle_mouse_event(priv->figure, event);
+      g_free(event);
+    }
+  _view_flush_motion(self);
+}
+
+static void _view_flush_motion(SlopeView *self)
+{
+  SlopeViewPrivate *priv = slope_view_get_instance_private (self);
+  /* presses and releases must see the motion that came before them */
+  if (priv->motion_pending)
+    {
+      priv->motion_pending = FALSE;
+      _figure_handle_mouse_event(priv->figure, &priv->motion_event);
+    }
+}
+
+static gboolean _view_tick(GtkWidget *widget, GdkFrameClock *frame_clock, gpointer user_data)
+{
+  SlopeView *       self = SLOPE_VIEW(widget);
+  SlopeViewPrivate *priv = slope_view_get_instance_private (self);
+  SLOPE_UNUSED(frame_clock);
+  SLOPE_UNUSED(user_data);
+  if (priv->render_task != NULL)
+    {
+      /* the completion of the frame in flight ticks again */
+      priv->tick_id = 0;
+      return G_SOURCE_REMOVE;
+    }
+  /* tick_id is still set, so the requests made by the event
+     handling below join this frame instead of the next one */
+  _view_flush_events(self);
+  if (priv->frame_pending)
+    {
+      priv->frame_pending = FALSE;
+      if (priv->async && priv->figure != NULL)
+        {
+          _view_start_render(self);
+        }
+      else
+        {
+          /* the update phase runs before painting, so this is
+             drawn in the current frame */
+          gtk_widget_queue_draw(widget);
+        }
+    }
+  priv->tick_id = 0;
+  return G_SOURCE_REMOVE;
+}
+
+static void _view_start_render(SlopeView *self)
+{
+  SlopeViewPrivate *priv = slope_view_get_instance_private (self);
+  GtkWidget *       widget = GTK_WIDGET(self);
+  SlopeViewRenderJob *   job;
+
+  priv->frame_width  = gtk_widget_get_width(widget);
+  priv->frame_height = gtk_widget_get_height(widget);
+  priv->frame_scale  = gtk_widget_get_scale_factor(widget);
+  if (priv->frame_width <= 0 || priv->frame_height <= 0)
+    {
+      return;
+    }
+  /* the producer queues are drained here, the worker only ever
+     sees data that arrived before the frame started. No frame is
+     in flight, so this never waits, and the setter calls put off
+     during the last frame are made on unlocking */
+  slope_figure_lock(priv->figure);
+  _figure_sync(priv->figure);
+  slope_figure_unlock(priv->figure);
+
+  job         = g_new(SlopeViewRenderJob, 1);
+  job->figure = g_object_ref(priv->figure);
+  job->width  = priv->frame_width;
+  job->height = priv->frame_height;
+  job->scale  = priv->frame_scale;
+
+  priv->render_cancellable = g_cancellable_new();
+  priv->render_task = g_task_new(self, priv->render_cancellable, _view_render_done, NULL);
+  g_task_set_task_data(priv->render_task, job, _view_render_job_free);
+  g_task_run_in_thread(priv->render_task, _view_render_thread);
+}
+
+static void _view_render_thread(GTask *       task,
+                                gpointer      source_object,
+                                gpointer      task_data,
+                                GCancellable *cancellable)
+{
+  SlopeViewRenderJob *  job = task_data;
+  cairo_surface_t *image;
+  cairo_t *        cr;
+  GBytes *         bytes;
+  GdkTexture *     texture;
+  int              width, height, stride;
+  SLOPE_UNUSED(source_object);
+
+  width  = job->width * job->scale;
+  height = job->height * job->scale;
+  image  = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+  cairo_surface_set_device_scale(image, job->scale, job->scale);
+  cr = cairo_create(image);
+
+  /* the device scale already gives the image its pixel density */
+  slope_figure_lock(job->figure);
+  _figure_set_cancellable(job->figure, cancellable);
+  _figure_set_retained(job->figure, TRUE, 1.0);
+  slope_figure_draw(job->figure, &GRAPHENE_RECT_INIT (0.0, 0.0, job->width, job->height), cr);
+  _figure_set_retained(job->figure, FALSE, 1.0);
+  _figure_set_cancellable(job->figure, NULL);
+  slope_figure_unlock(job->figure);
+  cairo_destroy(cr);
+
+  if (g_task_return_error_if_cancelled(task))
+    {
+      cairo_surface_destroy(image);
+      return;
+    }
+  /* cairo's ARGB32 is the native endian premultiplied format GDK
+     calls default, the texture takes the pixels without a copy */
+  cairo_surface_flush(image);
+  stride  = cairo_image_surface_get_stride(image);
+  bytes   = g_bytes_new_with_free_func(cairo_image_surface_get_data(image),
+                                       (gsize) stride * height,
+                                       (GDestroyNotify) cairo_surface_destroy,
+                                       image);
+  texture = gdk_memory_texture_new(width, height, GDK_MEMORY_DEFAULT, bytes, stride);
+  g_bytes_unref(bytes);
+  g_task_return_pointer(task, texture, g_object_unref);
+}
+
+static void _view_render_done(GObject *source_object, GAsyncResult *result, gpointer user_data)
+{
+  SlopeView *       self = SLOPE_VIEW(source_object);
+  SlopeViewPrivate *priv = slope_view_get_instance_private (self);
+  SlopeViewRenderJob *   job  = g_task_get_task_data(G_TASK(result));
+  GdkTexture *      texture;
+  SLOPE_UNUSED(user_data);
+
+  texture = g_task_propagate_pointer(G_TASK(result), NULL);
+  if (texture != NULL)
+    {
+      g_clear_object(&priv->frame_texture);
+      priv->frame_texture = texture;
+      priv->frame_bounds  = GRAPHENE_RECT_INIT (0.0, 0.0, job->width, job->height);
+      priv->frame_time    = g_get_monotonic_time();
+      gtk_widget_queue_draw(GTK_WIDGET(self));
+    }
+  /* drops the job, and with it the figure and view references */
+  g_clear_object(&priv->render_task);
+  g_clear_object(&priv->render_cancellable);
+  /* anything that came in meanwhile can go through now */
+  if (priv->frame_pending || priv->motion_pending
+      || !g_queue_is_empty(&priv->event_queue))
+    {
+      _view_ensure_tick(self);
+    }
+}
+
+static void _view_render_job_free(gpointer data)
+{
+  SlopeViewRenderJob *job = data;
+  g_object_unref(job->figure);
+  g_free(job);
+}
+
+void slope_view_set_async(SlopeView *self, gboolean async)
+{
+  SlopeViewPrivate *priv = slope_view_get_instance_private (self);
+  if (priv->async == async)
+    {
+      return;
+    }
+  priv->async = async;
+  if (!async)
+    {
+      /* a frame still in flight lands in frame_texture unused */
+      g_clear_object(&priv->frame_texture);
+    }
+  priv->frame_width = 0;
+  slope_view_redraw(self);
+}
+
+gboolean slope_view_get_async(SlopeView *self)
+{
+  SlopeViewPrivate *priv = slope_view_get_instance_private (self);
+  return priv->async;
+}
+
+guint64 slope_view_get_coalesced_redraws(SlopeView *self)
+{
+  SlopeViewPrivate *priv = slope_view_get_instance_private (self);
+  return priv->coalesced_redraws;
 }
 
 void slope_view_set_figure(SlopeView *self, SlopeFigure *figure)
@@ -0,0 +1,31 @@
+/*
+ * Copyright (C) 2017,2023  Elvis Teixeira, Anatoliy Sokolov
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SLOPE_VIEW_P_H
+#define SLOPE_VIEW_P_H
+
+#include <slope/view.h>
+
+/* Asks for a frame without invalidating anything, for callers
+ * that invalidated what they changed themselves. Requests made
+ * before the next frame clock tick are merged into one draw */
+void _view_queue_frame(SlopeView *self);
+
+#endif /* SLOPE_VIEW_P_H */
@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2017,2023  Elvis Teixeira, Anatoliy Sokolov
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <slope/workers_p.h>
+
+typedef struct _SlopeWorkerBatch
+{
+  SlopeWorkerFunc func;
+  gpointer        user_data;
+  GMutex          lock;
+  GCond           done;
+  guint           pending;
+} SlopeWorkerBatch;
+
+typedef struct _SlopeWorkerTask
+{
+  SlopeWorkerBatch *batch;
+  gpointer          job;
+} SlopeWorkerTask;
+
+static GThreadPool *workers_pool = NULL;
+static GPrivate     workers_in_job = G_PRIVATE_INIT(NULL);
+
+static void _workers_thread_func(gpointer data, gpointer pool_data)
+{
+  SlopeWorkerTask * task  = data;
+  SlopeWorkerBatch *batch = task->batch;
+  SLOPE_UNUSED(pool_data);
+  g_private_set(&workers_in_job, GINT_TO_POINTER(TRUE));
+  batch->func(task->job, batch->user_data);
+  g_private_set(&workers_in_job, NULL);
+  g_mutex_lock(&batch->lock);
+  if (--batch->pending == 0)
+    {
+      g_cond_signal(&batch->done);
+    }
+  g_mutex_unlock(&batch->lock);
+}
+
+guint _workers_get_n_threads(void)
+{
+  return SLOPE_MAX(g_get_num_processors(), 1);
+}
+
+static GThreadPool *_workers_get_pool(void)
+{
+  static gsize pool_init = 0;
+  if (g_once_init_enter(&pool_init))
+    {
+      /* the caller also runs jobs, hence one thread less */
+      guint n_threads = _workers_get_n_threads();
+      if (n_threads > 1)
+        {
+          workers_pool = g_thread_pool_new(
+              _workers_thread_func, NULL, (gint) n_threads - 1, FALSE, NULL);
+        }
+      g_once_init_leave(&pool_init, 1);
+    }
+  return workers_pool;
+}
+
+void _workers_run(SlopeWorkerFunc func,
+                  gpointer        jobs,
+                  gsize           job_size,
+                  guint           n_jobs,
+                  gpointer        user_data)
+{
+  GThreadPool *     pool = _workers_get_pool();
+  SlopeWorkerBatch  batch;
+  SlopeWorkerTask * tasks;
+  guint             k;
+
+  if (n_jobs == 0)
+    {
+      return;
+    }
+  if (n_jobs == 1 || pool == NULL || g_private_get(&workers_in_job) != NULL)
+    {
+      for (k = 0; k < n_jobs; ++k)
+        {
+          func((guint8 *) jobs + k * job_size, user_data);
+        }
+      return;
+    }
+
+  batch.func      = func;
+  batch.user_data = user_data;
+  batch.pending   = n_jobs - 1;
+  g_mutex_init(&batch.lock);
+  g_cond_init(&batch.done);
+  tasks = g_new(SlopeWorkerTask, n_jobs);
+  for (k = 1; k < n_jobs; ++k)
+    {
+      tasks[k].batch = &batch;
+      tasks[k].job   = (guint8 *) jobs + k * job_size;
+      g_thread_pool_push(pool, &tasks[k], NULL);
+    }
+  g_private_set(&workers_in_job, GINT_TO_POINTER(TRUE));
+  func(jobs, user_data);
+  g_private_set(&workers_in_job, NULL);
+
+  g_mutex_lock(&batch.lock);
+  while (batch.pending > 0)
+    {
+      g_cond_wait(&batch.done, &batch.lock);
+    }
+  g_mutex_unlock(&batch.lock);
+  g_mutex_clear(&batch.lock);
+  g_cond_clear(&batch.done);
+  g_free(tasks);
+}
+
+/* slope/workers.c */
@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2017,2023  Elvis Teixeira, Anatoliy Sokolov
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SLOPE_WORKERS_P_H
+#define SLOPE_WORKERS_P_H
+
+#include <slope/drawing.h>
+
+/* Process wide thread pool for the data parallel parts of the
+ * rendering, sized to the number of processors. */
+typedef void (*SlopeWorkerFunc)(gpointer job, gpointer user_data);
+
+guint _workers_get_n_threads(void);
+
+/* Calls func on each of the n_jobs elements (job_size bytes each)
+ * of jobs in parallel and returns once all of them finished. The
+ * calling thread runs a share of the jobs itself. When called from
+ * inside a job everything runs in the calling thread, so nested
+ * parallel sections can not deadlock the pool. */
+void _workers_run(SlopeWorkerFunc func,
+                  gpointer        jobs,
+                  gsize           job_size,
+                  guint           n_jobs,
+                  gpointer        user_data);
+
+#endif /* SLOPE_WORKERS_P_H */
@@ -49,6 +49,7 @@ static void _xyaxis_get_data_rect (SlopeItem *self, graphene_rect_t *rect);
 static void _xyaxis_draw(SlopeItem *self, cairo_t *cr);
 static void _xyaxis_draw_horizontal(SlopeXyAxis *self, cairo_t *cr);
 static void _xyaxis_draw_vertical(SlopeXyAxis *self, cairo_t *cr);
+static graphene_point_t *_xyaxis_map_samples(SlopeXyAxis *self, GList *sample_list);
 
 static void slope_xyaxis_class_init(SlopeXyAxisClass *klass)
 {
@@ -120,6 +121,36 @@ static void _xyaxis_draw(SlopeItem *self, cairo_t *cr)
     }
 }
 
+static graphene_point_t *_xyaxis_map_samples(SlopeXyAxis *self, GList *sample_list)
+{
+  SlopeXyAxisPrivate *priv = slope_xyaxis_get_instance_private (self);
+  SlopeScale *        scale = slope_item_get_scale(SLOPE_ITEM(self));
+  guint               n_samples = g_list_length(sample_list);
+  graphene_point_t *  res = g_new(graphene_point_t, n_samples + 1);
+  double *            x_vec = g_new(double, 2 * n_samples + 2);
+  double *            y_vec = x_vec + n_samples + 1;
+  GList *             iter;
+  long                k = 0L;
+  /* map every sample position with a single scale call */
+  for (iter = sample_list; iter != NULL; iter = iter->next, ++k)
+    {
+      SlopeSample *sample = SLOPE_XYAXIS_SAMPLE(iter->data);
+      if (priv->orientation == GTK_ORIENTATION_HORIZONTAL)
+        {
+          x_vec[k] = sample->coord;
+          y_vec[k] = priv->anchor;
+        }
+      else
+        {
+          x_vec[k] = priv->anchor;
+          y_vec[k] = sample->coord;
+        }
+    }
+  slope_scale_map_array(scale, res, x_vec, y_vec, k);
+  g_free(x_vec);
+  return res;
+}
+
 static void _xyaxis_draw_horizontal(SlopeXyAxis *self, cairo_t *cr)
 {
   SlopeXyAxisPrivate *priv = slope_xyaxis_get_instance_private (self);
@@ -128,6 +159,8 @@ static void _xyaxis_draw_horizontal(SlopeXyAxis *self, cairo_t *cr)
   graphene_rect_t      scale_fig_rect;
   graphene_point_t     p, p1, p2, pt1, pt2;
   GList *              sample_list, *iter;
+  graphene_point_t *   sample_pts;
+  long                 k;
   double               txt_height;
   guint32              sampler_mode;
   slope_scale_get_figure_rect (scale, &scale_fig_rect);
@@ -167,6 +200,8 @@ static void _xyaxis_draw_horizontal(SlopeXyAxis *self, cairo_t *cr)
   pt2.y       = graphene_rect_get_y (&scale_fig_rect)
                 + graphene_rect_get_height (&scale_fig_rect);
   iter        = sample_list;
+  sample_pts  = _xyaxis_map_samples(self, sample_list);
+  k           = 0L;
 
   while (iter != NULL)
     {
@@ -175,14 +210,12 @@ static void _xyaxis_draw_horizontal(SlopeXyAxis *self, cairo_t *cr)
 
       sample = SLOPE_XYAXIS_SAMPLE(iter->data);
       iter   = iter->next;
+      sample_p1 = sample_pts[k++];
       if (sample->coord < priv->min || sample->coord > priv->max)
         {
           continue;
         }
 
-      p.x = sample->coord;
-      p.y = priv->anchor;
-      slope_scale_map(scale, &sample_p1, &p);
       sample_p2 = sample_p1;
       sample_p2.y += (priv->component & SLOPE_XYAXIS_TICKS_DOWN) ? -4.0 : 4.0;
 
@@ -218,6 +251,7 @@ static void _xyaxis_draw_horizontal(SlopeXyAxis *self, cairo_t *cr)
               sample->label);
         }
     }
+  g_free(sample_pts);
 
   if (priv->title != NULL && (priv->component & SLOPE_XYAXIS_TITLE))
     {
@@ -255,6 +289,8 @@ static void _xyaxis_draw_vertical(SlopeXyAxis *self, cairo_t *cr)
   graphene_rect_t      scale_fig_rect;
   graphene_point_t     p, p1, p2, pt1, pt2;
   GList *              sample_list, *iter;
+  graphene_point_t *   sample_pts;
+  long                 k;
   double               txt_height, max_txt_width = 0.0;
   guint32              sampler_mode;
 
@@ -292,6 +328,8 @@ static void _xyaxis_draw_vertical(SlopeXyAxis *self, cairo_t *cr)
 
   sample_list = slope_sampler_get_sample_list(priv->sampler);
   iter        = sample_list;
+  sample_pts  = _xyaxis_map_samples(self, sample_list);
+  k           = 0L;
   pt1.x       = graphene_rect_get_x (&scale_fig_rect);
   pt2.x       = graphene_rect_get_x (&scale_fig_rect)
                 + graphene_rect_get_width (&scale_fig_rect);
@@ -303,14 +341,12 @@ static void _xyaxis_draw_vertical(SlopeXyAxis *self, cairo_t *cr)
 
       sample = SLOPE_XYAXIS_SAMPLE(iter->data);
       iter   = iter->next;
+      sample_p1 = sample_pts[k++];
       if (sample->coord < priv->min || sample->coord > priv->max)
         {
           continue;
         }
 
-      p.x = priv->anchor;
-      p.y = sample->coord;
-      slope_scale_map(scale, &sample_p1, &p);
       sample_p2 = sample_p1;
       sample_p2.x += (priv->component & SLOPE_XYAXIS_TICKS_DOWN) ? +4.0 : -4.0;
 
@@ -347,6 +383,7 @@ static void _xyaxis_draw_vertical(SlopeXyAxis *self, cairo_t *cr)
               sample->label);
         }
     }
+  g_free(sample_pts);
 
   if (priv->title != NULL && (priv->component & SLOPE_XYAXIS_TITLE))
     {
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2017,2023  Elvis Teixeira, Anatoliy Sokolov
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <slope/simd_p.h>
+#include <slope/xybuffer_p.h>
+
+SlopeXyBuffer *_xybuffer_new(void)
+{
+  SlopeXyBuffer *self = g_new0(SlopeXyBuffer, 1);
+  g_atomic_ref_count_init(&self->ref_count);
+  return self;
+}
+
+SlopeXyBuffer *_xybuffer_ref(SlopeXyBuffer *self)
+{
+  g_atomic_ref_count_inc(&self->ref_count);
+  return self;
+}
+
+void _xybuffer_unref(SlopeXyBuffer *self)
+{
+  if (self != NULL && g_atomic_ref_count_dec(&self->ref_count))
+    {
+      g_free(self->x_vec);
+      g_free(self->y_vec);
+      g_free(self);
+    }
+}
+
+gboolean _xybuffer_is_exclusive(SlopeXyBuffer *self)
+{
+  return g_atomic_ref_count_compare(&self->ref_count, 1);
+}
+
+void _xybuffer_reserve(SlopeXyBuffer *self, long n_pts)
+{
+  if (n_pts > self->capacity)
+    {
+      g_free(self->x_vec);
+      g_free(self->y_vec);
+      self->x_vec    = g_new(double, n_pts);
+      self->y_vec    = g_new(double, n_pts);
+      self->capacity = n_pts;
+    }
+  self->n_pts = n_pts;
+}
+
+void _xybuffer_update_bounds(SlopeXyBuffer *self)
+{
+  _simd_bounds(self->x_vec,
+               self->y_vec,
+               self->n_pts,
+               &self->x_min,
+               &self->x_max,
+               &self->y_min,
+               &self->y_max,
+               &self->x_sorted);
+}
+
+/* slope/xybuffer.c */
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2017,2023  Elvis Teixeira, Anatoliy Sokolov
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SLOPE_XYBUFFER_P_H
+#define SLOPE_XYBUFFER_P_H
+
+#include <slope/drawing.h>
+
+/* Reference counted x/y storage owned by a series. The writer
+ * thread fills one of these and computes its bounds before
+ * publishing it, the main thread only reads it. */
+typedef struct _SlopeXyBuffer
+{
+  gatomicrefcount ref_count;
+  double *        x_vec;
+  double *        y_vec;
+  long            n_pts;
+  long            capacity;
+  double          x_min, x_max;
+  double          y_min, y_max;
+  gboolean        x_sorted;
+  guint           epoch;
+} SlopeXyBuffer;
+
+SlopeXyBuffer *_xybuffer_new(void);
+
+SlopeXyBuffer *_xybuffer_ref(SlopeXyBuffer *self);
+
+void _xybuffer_unref(SlopeXyBuffer *self);
+
+/* TRUE if the caller holds the only reference */
+gboolean _xybuffer_is_exclusive(SlopeXyBuffer *self);
+
+/* Grows the arrays to hold n_pts, the contents are not kept */
+void _xybuffer_reserve(SlopeXyBuffer *self, long n_pts);
+
+void _xybuffer_update_bounds(SlopeXyBuffer *self);
+
+#endif /* SLOPE_XYBUFFER_P_H */
@@ -20,6 +20,8 @@
 
 #include <slope/figure_p.h>
 #include <slope/item_p.h>
+#include <slope/scale_p.h>
+#include <slope/simd_p.h>
 #include <slope/xyscale.h>
 
 #include <stdio.h>
@@ -42,6 +44,7 @@ typedef struct _SlopeXyScalePrivate
   graphene_point_t mouse_p2;
   GdkRGBA    mouse_rect_color;
   gboolean   on_drag;
+  gboolean   on_pan;
   int        interaction;
 } SlopeXyScalePrivate;
 
@@ -49,12 +52,19 @@ G_DEFINE_TYPE_WITH_CODE (SlopeXyScale, slope_xyscale, SLOPE_SCALE_TYPE, G_ADD_PR
 
 static void _xyscale_finalize(GObject *self);
 static void _xyscale_draw (SlopeScale *self, const graphene_rect_t *rect, cairo_t *cr);
+static void _xyscale_draw_overlay (SlopeScale *self, const graphene_rect_t *rect, cairo_t *cr);
+static void _xyscale_draw_axis (cairo_t *cr, gpointer data);
 static void _xyscale_map (SlopeScale *self,
                           graphene_point_t *res,
                           const graphene_point_t *src);
 static void _xyscale_unmap (SlopeScale *self,
                             graphene_point_t *res,
                             const graphene_point_t *src);
+static void _xyscale_map_array (SlopeScale *      self,
+                                graphene_point_t *res,
+                                const double *    x_vec,
+                                const double *    y_vec,
+                                long              n_pts);
 static void _xyscale_rescale(SlopeScale *self);
 static void _xyscale_get_figure_rect(SlopeScale *self, graphene_rect_t *rect);
 static void _xyscale_get_data_rect (SlopeScale *self, graphene_rect_t *rect);
@@ -63,6 +73,7 @@ static void _xyscale_apply_padding(SlopeXyScale *self);
 static void _xyscale_mouse_event(SlopeScale *self, SlopeMouseEvent *event);
 static void _xyscale_zoom_event(SlopeScale *self, SlopeMouseEvent *event);
 static void _xyscale_translate_event(SlopeScale *self, SlopeMouseEvent *event);
+static void _xyscale_end_pan(SlopeScale *self);
 
 static void slope_xyscale_class_init(SlopeXyScaleClass *klass)
 {
@@ -70,8 +81,10 @@ static void slope_xyscale_class_init(SlopeXyScaleClass *klass)
   SlopeScaleClass *scale_klass  = SLOPE_SCALE_CLASS(klass);
   object_klass->finalize        = _xyscale_finalize;
   scale_klass->draw             = _xyscale_draw;
+  scale_klass->draw_overlay     = _xyscale_draw_overlay;
   scale_klass->map              = _xyscale_map;
   scale_klass->unmap            = _xyscale_unmap;
+  scale_klass->map_array        = _xyscale_map_array;
   scale_klass->rescale          = _xyscale_rescale;
   scale_klass->get_data_rect    = _xyscale_get_data_rect;
   scale_klass->get_figure_rect  = _xyscale_get_figure_rect;
@@ -102,6 +115,7 @@ static void slope_xyscale_init(SlopeXyScale *self)
   priv->horiz_pad        = 0.05;
   priv->vertical_pad     = 0.05;
   priv->on_drag          = FALSE;
+  priv->on_pan           = FALSE;
   gdk_rgba_parse (&priv->mouse_rect_color, "dimgray");
   priv->interaction      = SLOPE_XYSCALE_INTERACTION_TRANSLATE;
   slope_scale_rescale(SLOPE_SCALE(self));
@@ -148,7 +162,8 @@ SlopeScale *slope_xyscale_new_axis(const char *x_title,
 static void _xyscale_draw(SlopeScale *self, const graphene_rect_t *rect, cairo_t *cr)
 {
   SlopeXyScalePrivate *priv = slope_xyscale_get_instance_private (SLOPE_XYSCALE (self));
-  int                  k;
+  double               render_scale;
+  gint64               begin;
 
   // TODE: Use graphene_rect_inset.
   priv->fig_x_min = graphene_rect_get_x (rect) + priv->left_margin;
@@ -169,8 +184,24 @@ static void _xyscale_draw(SlopeScale *self, const graphene_rect_t *rect, cairo_t
 
   cairo_restore(cr);
 
-  /* draw axis */
+  /* draw axis, grid lines and tick labels only change with the
+     ranges and the geometry, so views keep them in a layer */
+  begin = _scale_stage_begin(self);
   _xyscale_position_axis(self);
+  if (!_scale_get_retained(self, &render_scale)
+      || !_layer_draw(_scale_get_frame_layer(self), cr, rect, render_scale,
+                      _xyscale_draw_axis, self))
+    {
+      _xyscale_draw_axis(cr, self);
+    }
+  _scale_stage_end(self, SLOPE_RENDER_AXES, begin);
+}
+
+static void _xyscale_draw_axis(cairo_t *cr, gpointer data)
+{
+  SlopeXyScalePrivate *priv = slope_xyscale_get_instance_private (SLOPE_XYSCALE (data));
+  int                  k;
+
   for (k = 0; k < MAX_AXIS; ++k)
     {
       if (slope_item_get_is_visible(priv->axis[k]) == TRUE)
@@ -178,6 +209,12 @@ static void _xyscale_draw(SlopeScale *self, const graphene_rect_t *rect, cairo_t
           _item_draw(priv->axis[k], cr);
         }
     }
+}
+
+static void _xyscale_draw_overlay(SlopeScale *self, const graphene_rect_t *rect, cairo_t *cr)
+{
+  SlopeXyScalePrivate *priv = slope_xyscale_get_instance_private (SLOPE_XYSCALE (self));
+  SLOPE_UNUSED(rect);
 
   if (priv->on_drag == TRUE)
     {
@@ -213,6 +250,24 @@ _xyscale_map (SlopeScale * self,
   res->y = priv->fig_y_max - tmp * priv->fig_height;
 }
 
+static void
+_xyscale_map_array (SlopeScale *      self,
+                    graphene_point_t *res,
+                    const double *    x_vec,
+                    const double *    y_vec,
+                    long              n_pts)
+{
+  SlopeXyScalePrivate *priv = slope_xyscale_get_instance_private (SLOPE_XYSCALE (self));
+  double               x_scale, y_scale;
+
+  /* same transform as _xyscale_map() folded into a*v + b */
+  x_scale = priv->fig_width / priv->dat_width;
+  y_scale = priv->fig_height / priv->dat_height;
+  _simd_affine_map(res, x_vec, y_vec, n_pts,
+                   x_scale, priv->fig_x_min - priv->dat_x_min * x_scale,
+                   -y_scale, priv->fig_y_max + priv->dat_y_min * y_scale);
+}
+
 static void
 _xyscale_unmap (SlopeScale *self,
                 graphene_point_t *res,
@@ -231,35 +286,22 @@ _xyscale_unmap (SlopeScale *self,
 static void _xyscale_rescale(SlopeScale *self)
 {
   SlopeXyScalePrivate *priv;
-  GList *              iter, *list;
-  SlopeItem *          item;
   graphene_rect_t      rect;
+  double               old_x_min, old_x_max, old_y_min, old_y_max;
 
   priv = slope_xyscale_get_instance_private (SLOPE_XYSCALE (self));
-  list = slope_scale_get_item_list(self);
 
-  if (list == NULL)
+  if (!_scale_get_items_rect(self, &rect))
     {
       slope_xyscale_set_x_range(SLOPE_XYSCALE(self), 0.0, 1.0);
       slope_xyscale_set_y_range(SLOPE_XYSCALE(self), 0.0, 1.0);
       return;
     }
 
-  iter = list;
-  item = SLOPE_ITEM(iter->data);
-  slope_item_get_data_rect (item, &rect);
-
-  while (iter != NULL)
-    {
-      graphene_rect_t      item_rect_i;
-
-      item = SLOPE_ITEM(iter->data);
-      iter = iter->next;
-
-      slope_item_get_data_rect (item, &item_rect_i);
-      graphene_rect_union (&rect, &item_rect_i, &rect);
-
-    }
+  old_x_min = priv->dat_x_min;
+  old_x_max = priv->dat_x_max;
+  old_y_min = priv->dat_y_min;
+  old_y_max = priv->dat_y_max;
 
   priv->dat_x_min = graphene_rect_get_x (&rect);
   priv->dat_x_max = graphene_rect_get_x (&rect) + graphene_rect_get_width (&rect);
@@ -267,6 +309,13 @@ static void _xyscale_rescale(SlopeScale *self)
   priv->dat_y_max = graphene_rect_get_y (&rect) + graphene_rect_get_height (&rect);
 
   _xyscale_apply_padding(SLOPE_XYSCALE(self));
+
+  /* new data inside the old ranges only dirties its own item */
+  if (old_x_min != priv->dat_x_min || old_x_max != priv->dat_x_max
+      || old_y_min != priv->dat_y_min || old_y_max != priv->dat_y_max)
+    {
+      slope_scale_invalidate(self);
+    }
 }
 
 static void _xyscale_apply_padding(SlopeXyScale *self)
@@ -454,6 +503,7 @@ void slope_xyscale_set_axis(SlopeXyScale *self, int axis_flag)
           SLOPE_XYAXIS(priv->axis[SLOPE_XYSCALE_AXIS_TOP]), SLOPE_XYAXIS_LINE);
       break;
     }
+  slope_scale_invalidate(SLOPE_SCALE(self));
 }
 
 SlopeItem *slope_xyscale_get_axis(SlopeXyScale *self, int axis_id)
@@ -462,22 +512,57 @@ SlopeItem *slope_xyscale_get_axis(SlopeXyScale *self, int axis_id)
   return priv->axis[axis_id];
 }
 
+static void _xyscale_set_x_range_call(const SlopeFigureCall *call)
+{
+  slope_xyscale_set_x_range(call->object, call->d[0], call->d[1]);
+}
+
 void slope_xyscale_set_x_range(SlopeXyScale *self, double min, double max)
 {
-  SlopeXyScalePrivate *priv = slope_xyscale_get_instance_private (self);
+  SlopeXyScalePrivate *priv   = slope_xyscale_get_instance_private (self);
+  SlopeFigure *        figure = _figure_of_scale(SLOPE_SCALE(self));
+  SlopeFigureCall      call   = {.object = self, .d = {min, max}};
 
-  priv->dat_x_min = min;
-  priv->dat_x_max = max;
-  priv->dat_width = max - min;
+  if (!_figure_begin_change(figure, _xyscale_set_x_range_call, &call))
+    {
+      return;
+    }
+  /* a pending rescale would otherwise overwrite these later */
+  _scale_update(SLOPE_SCALE(self));
+  if (priv->dat_x_min != min || priv->dat_x_max != max)
+    {
+      priv->dat_x_min = min;
+      priv->dat_x_max = max;
+      priv->dat_width = max - min;
+      slope_scale_invalidate(SLOPE_SCALE(self));
+    }
+  _figure_end_change(figure);
+}
+
+static void _xyscale_set_y_range_call(const SlopeFigureCall *call)
+{
+  slope_xyscale_set_y_range(call->object, call->d[0], call->d[1]);
 }
 
 void slope_xyscale_set_y_range(SlopeXyScale *self, double min, double max)
 {
-  SlopeXyScalePrivate *priv = slope_xyscale_get_instance_private (self);
+  SlopeXyScalePrivate *priv   = slope_xyscale_get_instance_private (self);
+  SlopeFigure *        figure = _figure_of_scale(SLOPE_SCALE(self));
+  SlopeFigureCall      call   = {.object = self, .d = {min, max}};
 
-  priv->dat_y_min  = min;
-  priv->dat_y_max  = max;
-  priv->dat_height = max - min;
+  if (!_figure_begin_change(figure, _xyscale_set_y_range_call, &call))
+    {
+      return;
+    }
+  _scale_update(SLOPE_SCALE(self));
+  if (priv->dat_y_min != min || priv->dat_y_max != max)
+    {
+      priv->dat_y_min  = min;
+      priv->dat_y_max  = max;
+      priv->dat_height = max - min;
+      slope_scale_invalidate(SLOPE_SCALE(self));
+    }
+  _figure_end_change(figure);
 }
 
 static void _xyscale_mouse_event(SlopeScale *self, SlopeMouseEvent *event)
@@ -498,6 +583,10 @@ static void _xyscale_mouse_event(SlopeScale *self, SlopeMouseEvent *event)
           priv->on_drag = FALSE;
           _figure_request_redraw(figure);
         }
+      if (priv->on_pan == TRUE)
+        {
+          _xyscale_end_pan(self);
+        }
       return;
     }
 
@@ -515,7 +604,8 @@ static void _xyscale_mouse_event(SlopeScale *self, SlopeMouseEvent *event)
     }
   else if (event->button == SLOPE_MOUSE_BUTTON_RIGHT)
     {
-      slope_scale_rescale(self);
+      /* the cached union of the items is still good */
+      _scale_request_rescale(self);
       _figure_request_redraw(figure);
     }
 
@@ -601,8 +691,15 @@ static void _xyscale_translate_event(SlopeScale *self, SlopeMouseEvent *event)
       graphene_point_t data_p1, data_p2;
       double     dx, dy;
 
-      priv->mouse_p2.x = event->x;
-      priv->mouse_p2.y = event->y;
+      /* move by whole figure units, so that the data layers can be
+         scrolled by whole pixels, the rest waits for the next event */
+      priv->mouse_p2.x = priv->mouse_p1.x + round(event->x - priv->mouse_p1.x);
+      priv->mouse_p2.y = priv->mouse_p1.y + round(event->y - priv->mouse_p1.y);
+      if (priv->mouse_p2.x == priv->mouse_p1.x
+          && priv->mouse_p2.y == priv->mouse_p1.y)
+        {
+          return;
+        }
 
       slope_scale_unmap(self, &data_p1, &priv->mouse_p1);
       slope_scale_unmap(self, &data_p2, &priv->mouse_p2);
@@ -610,18 +707,35 @@ static void _xyscale_translate_event(SlopeScale *self, SlopeMouseEvent *event)
       dx = data_p2.x - data_p1.x;
       dy = data_p2.y - data_p1.y;
 
-      data_p1.x = priv->dat_x_min - dx;
-      data_p1.y = priv->dat_y_min - dy;
-
-      data_p2.x = priv->dat_x_max - dx;
-      data_p2.y = priv->dat_y_max - dy;
-
-      slope_xyscale_set_x_range(SLOPE_XYSCALE(self), data_p1.x, data_p2.x);
-      slope_xyscale_set_y_range(SLOPE_XYSCALE(self), data_p1.y, data_p2.y);
+      /* set the ranges directly, slope_xyscale_set_x_range() would
+         throw the data layers away */
+      priv->dat_x_min -= dx;
+      priv->dat_x_max -= dx;
+      priv->dat_y_min -= dy;
+      priv->dat_y_max -= dy;
+      _scale_scroll(self,
+                    priv->mouse_p2.x - priv->mouse_p1.x,
+                    priv->mouse_p2.y - priv->mouse_p1.y);
+      priv->on_pan = TRUE;
 
       priv->mouse_p1 = priv->mouse_p2;
       _figure_request_redraw(figure);
     }
+
+  else if (event->type == SLOPE_MOUSE_RELEASE && priv->on_pan == TRUE)
+    {
+      _xyscale_end_pan(self);
+    }
+}
+
+static void _xyscale_end_pan(SlopeScale *self)
+{
+  SlopeXyScalePrivate *priv = slope_xyscale_get_instance_private (SLOPE_XYSCALE (self));
+  /* the layers were stitched together from strips while panning,
+     some of them at other detail levels, draw them whole again */
+  priv->on_pan = FALSE;
+  slope_scale_invalidate(self);
+  _figure_request_redraw(slope_scale_get_figure(self));
 }
 
 void slope_xyscale_set_interaction(SlopeXyScale *self, int interaction)
@@ -18,16 +18,42 @@
  * If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <slope/scale.h>
+#include <math.h>
+#include <slope/decimator_p.h>
+#include <slope/drawing_p.h>
+#include <slope/figure_p.h>
+#include <slope/pyramid_p.h>
+#include <slope/raster_p.h>
+#include <slope/item_p.h>
+#include <slope/samples_p.h>
+#include <slope/scale_p.h>
+#include <slope/simd_p.h>
+#include <slope/stamp_p.h>
+#include <slope/xybuffer_p.h>
 #include <slope/xyseries.h>
 
+/* points mapped per slope_scale_map_array() call while drawing */
+#define XYSERIES_MAP_CHUNK 256
+
+/* extra width, in figure units, around the clip when culling */
+#define XYSERIES_CLIP_MARGIN 8.0
+
+/* the largest grid used to merge coincident points in vector output */
+#define XYSERIES_MAX_POINT_CELLS (1L << 24)
+
+/* samples per block of the y index a clip to a few rows is culled with */
+#define XYSERIES_BAND_BLOCK 256L
+
 typedef struct _SlopeXySeriesPrivate
 {
   double        x_min, x_max;
   double        y_min, y_max;
-  const double *x_vec;
-  const double *y_vec;
+  SlopeSamples  x;
+  SlopeSamples  y;
   long          n_pts;
+  /* raw to value factors for the borrowed data */
+  double        x_scale, x_offset;
+  double        y_scale, y_offset;
   GdkRGBA       line_color;
   GdkRGBA       symbol_stroke_color;
   GdkRGBA       symbol_fill_color;
@@ -36,6 +62,31 @@ typedef struct _SlopeXySeriesPrivate
   double        symbol_small_radius;
   double        symbol_big_radius;
   gboolean      antialias;
+  gboolean      decimate;
+  SlopePyramid *lod;
+  SlopeStamp *  stamp;
+  gboolean      lod_valid;
+  /* y index for the clips that cover only a band of rows, built
+   * when one is drawn if the series has no pyramid of its own */
+  SlopePyramid *band_index;
+  gboolean      band_index_valid;
+  gboolean      x_sorted_hint;
+  gboolean      x_sorted;
+  /* the borrowed buffers the bounds were last scanned from, so
+   * that updating them again only scans what was appended */
+  SlopeBounds   bounds;
+  SlopeSamples  bounds_x;
+  SlopeSamples  bounds_y;
+  long          bounds_n_pts;
+  /* owned data: front is drawn, back is being filled by the
+   * writer, pending waits for the next frame and spare is a
+   * drawn buffer handed back to the writer for reuse */
+  SlopeXyBuffer *front;
+  SlopeXyBuffer *back;
+  gpointer       pending;
+  gpointer       spare;
+  guint          epoch;
+  gint           write_epoch;
   int           mode;
 } SlopeXySeriesPrivate;
 
@@ -46,9 +97,40 @@ static void _xyseries_draw_thumb (SlopeItem *       self,
 static void _xyseries_finalize(GObject *self);
 static void _xyseries_get_figure_rect (SlopeItem *self, graphene_rect_t *rect);
 static void _xyseries_get_data_rect (SlopeItem *self, graphene_rect_t *rect);
+static void _xyseries_visible_range(SlopeXySeries *self,
+                                    cairo_t *      cr,
+                                    long *         k_begin,
+                                    long *         k_end);
+static long _xyseries_band_runs(SlopeXySeries *self,
+                                cairo_t *      cr,
+                                long           k_begin,
+                                long           k_end,
+                                long **        runs);
+static void _xyseries_add_line_path(SlopeXySeries *   self,
+                                    cairo_t *         cr,
+                                    long              k_begin,
+                                    long              k_end,
+                                    graphene_point_t *first,
+                                    graphene_point_t *last);
+static gboolean _xyseries_add_lod_path(SlopeXySeries *   self,
+                                       cairo_t *         cr,
+                                       long              k_begin,
+                                       long              k_end,
+                                       graphene_point_t *first,
+                                       graphene_point_t *last);
+static void _xyseries_push_range(SlopeXySeries * self,
+                                 SlopeDecimator *decimator,
+                                 long            k_begin,
+                                 long            k_end);
 static void _xyseries_draw_line(SlopeXySeries *self, cairo_t *cr);
-static void _xyseries_draw_circles(SlopeXySeries *self, cairo_t *cr);
+static gboolean _xyseries_symbol_mode(int mode);
+static void _xyseries_draw_symbols(SlopeXySeries *self, cairo_t *cr);
+static void _xyseries_draw_points(SlopeXySeries *self, cairo_t *cr);
 static void _xyseries_draw_areaunder(SlopeXySeries *self, cairo_t *cr);
+static void _xyseries_sync(SlopeItem *self);
+static void _xyseries_data_changed(SlopeXySeries *self, gboolean append);
+static void _xyseries_scan(SlopeXySeries *self, gboolean append);
+static void _xyseries_recycle(SlopeXySeries *self, SlopeXyBuffer *buffer);
 static const gchar * _xyseries_color_parse (char c);
 
 G_DEFINE_TYPE_WITH_CODE (SlopeXySeries, slope_xyseries, SLOPE_ITEM_TYPE, G_ADD_PRIVATE (SlopeXySeries))
@@ -62,6 +144,7 @@ static void slope_xyseries_class_init(SlopeXySeriesClass *klass)
   item_klass->draw_thumb       = _xyseries_draw_thumb;
   item_klass->get_data_rect    = _xyseries_get_data_rect;
   item_klass->get_figure_rect  = _xyseries_get_figure_rect;
+  item_klass->sync             = _xyseries_sync;
 }
 
 static void slope_xyseries_init(SlopeXySeries *self)
@@ -77,11 +160,41 @@ static void slope_xyseries_init(SlopeXySeries *self)
   priv->symbol_small_radius  = 3.0;
   priv->symbol_big_radius    = 4.0;
   priv->antialias            = TRUE;
+  priv->decimate             = FALSE;
+  priv->lod                  = _pyramid_new();
+  priv->stamp                = _stamp_new();
+  priv->lod_valid            = FALSE;
+  priv->band_index           = _pyramid_new();
+  priv->band_index_valid     = FALSE;
+  priv->x_sorted_hint        = FALSE;
+  priv->x_sorted             = FALSE;
+  _samples_init(&priv->x, NULL, SLOPE_SAMPLE_DOUBLE, 1.0, 0.0);
+  _samples_init(&priv->y, NULL, SLOPE_SAMPLE_DOUBLE, 1.0, 0.0);
+  priv->x_scale              = 1.0;
+  priv->x_offset             = 0.0;
+  priv->y_scale              = 1.0;
+  priv->y_offset             = 0.0;
+  priv->bounds_x             = priv->x;
+  priv->bounds_y             = priv->y;
+  priv->bounds_n_pts         = 0L;
+  priv->front                = NULL;
+  priv->back                 = NULL;
+  priv->pending              = NULL;
+  priv->spare                = NULL;
+  priv->epoch                = 0;
+  priv->write_epoch          = 0;
 }
 
 void _xyseries_finalize(GObject *self)
 {
-  /* nothing to do */
+  SlopeXySeriesPrivate *priv = slope_xyseries_get_instance_private (SLOPE_XYSERIES (self));
+  _pyramid_destroy(priv->lod);
+  _pyramid_destroy(priv->band_index);
+  _stamp_destroy(priv->stamp);
+  _xybuffer_unref(priv->front);
+  _xybuffer_unref(priv->back);
+  _xybuffer_unref(priv->pending);
+  _xybuffer_unref(priv->spare);
   G_OBJECT_CLASS(slope_xyseries_parent_class)->finalize(self);
 }
 
@@ -109,15 +222,93 @@ void slope_xyseries_set_data(SlopeXySeries *self,
                              const double * y_vec,
                              long           n_pts)
 {
-  SlopeXySeriesPrivate *priv = slope_xyseries_get_instance_private (self);
+  slope_xyseries_set_samples(
+      self, x_vec, SLOPE_SAMPLE_DOUBLE, y_vec, SLOPE_SAMPLE_DOUBLE, n_pts);
+}
+
+static void _xyseries_set_samples_call(const SlopeFigureCall *call)
+{
+  slope_xyseries_set_samples(call->object, call->p[0], call->i[0], call->p[1], call->i[1], call->n);
+}
+
+void slope_xyseries_set_samples(SlopeXySeries * self,
+                                gconstpointer   x_vec,
+                                SlopeSampleType x_type,
+                                gconstpointer   y_vec,
+                                SlopeSampleType y_type,
+                                long            n_pts)
+{
+  SlopeXySeriesPrivate *priv   = slope_xyseries_get_instance_private (self);
+  SlopeFigure *         figure = _figure_of_scale(slope_item_get_scale(SLOPE_ITEM(self)));
+  SlopeFigureCall       call   = {.object = self,
+                                  .p      = {(gpointer) x_vec, (gpointer) y_vec},
+                                  .n      = n_pts,
+                                  .i      = {x_type, y_type}};
+  if (!_figure_begin_change(figure, _xyseries_set_samples_call, &call))
+    {
+      return;
+    }
+  /* the pyramid and the sorted x detection are only trusted
+   * again after slope_xyseries_update() */
+  priv->lod_valid        = FALSE;
+  priv->band_index_valid = FALSE;
+  priv->x_sorted         = FALSE;
+  if (priv->front != NULL)
+    {
+      /* back to borrowed data */
+      _xyseries_recycle(self, priv->front);
+      priv->front = NULL;
+    }
   if (x_vec == NULL || y_vec == NULL || n_pts < 1L)
     {
-      priv->n_pts = 0;
+      priv->n_pts        = 0;
+      priv->bounds_n_pts = 0L;
+    }
+  else
+    {
+      _samples_init(&priv->x, x_vec, x_type, priv->x_scale, priv->x_offset);
+      _samples_init(&priv->y, y_vec, y_type, priv->y_scale, priv->y_offset);
+      priv->n_pts = n_pts;
+    }
+  slope_item_invalidate(SLOPE_ITEM(self));
+  _figure_end_change(figure);
+}
+
+static void _xyseries_set_calibration_call(const SlopeFigureCall *call)
+{
+  slope_xyseries_set_calibration(call->object, call->d[0], call->d[1], call->d[2], call->d[3]);
+}
+
+void slope_xyseries_set_calibration(SlopeXySeries *self,
+                                    double         x_scale,
+                                    double         x_offset,
+                                    double         y_scale,
+                                    double         y_offset)
+{
+  SlopeXySeriesPrivate *priv   = slope_xyseries_get_instance_private (self);
+  SlopeFigure *         figure = _figure_of_scale(slope_item_get_scale(SLOPE_ITEM(self)));
+  SlopeFigureCall       call   = {.object = self, .d = {x_scale, x_offset, y_scale, y_offset}};
+  if (!_figure_begin_change(figure, _xyseries_set_calibration_call, &call))
+    {
       return;
     }
-  priv->x_vec = x_vec;
-  priv->y_vec = y_vec;
-  priv->n_pts = n_pts;
+  priv->x_scale  = x_scale;
+  priv->x_offset = x_offset;
+  priv->y_scale  = y_scale;
+  priv->y_offset = y_offset;
+  priv->bounds_n_pts     = 0L;
+  priv->lod_valid        = FALSE;
+  priv->band_index_valid = FALSE;
+  slope_item_invalidate(SLOPE_ITEM(self));
+  /* owned data is never calibrated, the borrowed data is read
+   * with the new factors right away */
+  if (priv->front == NULL && priv->n_pts > 0L)
+    {
+      _samples_init(&priv->x, priv->x.data, priv->x.type, x_scale, x_offset);
+      _samples_init(&priv->y, priv->y.data, priv->y.type, y_scale, y_offset);
+      _xyseries_scan(self, FALSE);
+    }
+  _figure_end_change(figure);
 }
 
 void slope_xyseries_update_data(SlopeXySeries *self,
@@ -132,31 +323,36 @@ void slope_xyseries_update_data(SlopeXySeries *self,
 static void _xyseries_draw(SlopeItem *self, cairo_t *cr)
 {
   SlopeXySeriesPrivate *priv = slope_xyseries_get_instance_private (SLOPE_XYSERIES (self));
+  SlopeXyBuffer *       pinned;
   if (priv->n_pts == 0L)
     {
       return;
     }
+  /* keep the owned data alive for the whole frame */
+  pinned = (priv->front != NULL) ? _xybuffer_ref(priv->front) : NULL;
   slope_cairo_set_antialias(cr, priv->antialias);
   if (priv->mode == SLOPE_SERIES_LINE)
     {
       _xyseries_draw_line(SLOPE_XYSERIES(self), cr);
     }
-  else if (priv->mode == SLOPE_SERIES_CIRCLES ||
-           priv->mode == SLOPE_SERIES_BIGCIRCLES)
-    {
-      _xyseries_draw_circles(SLOPE_XYSERIES(self), cr);
-    }
-  else if (priv->mode == (SLOPE_SERIES_LINE | SLOPE_SERIES_CIRCLES) ||
-           priv->mode == (SLOPE_SERIES_LINE | SLOPE_SERIES_BIGCIRCLES))
+  else if (_xyseries_symbol_mode(priv->mode))
     {
-      /* TODO: write a dedicate function to improve performance */
-      _xyseries_draw_line(SLOPE_XYSERIES(self), cr);
-      _xyseries_draw_circles(SLOPE_XYSERIES(self), cr);
+      if (priv->mode & SLOPE_SERIES_LINE)
+        {
+          _xyseries_draw_line(SLOPE_XYSERIES(self), cr);
+        }
+      _xyseries_draw_symbols(SLOPE_XYSERIES(self), cr);
     }
   else if (priv->mode == SLOPE_SERIES_AREAUNDER)
     {
       _xyseries_draw_areaunder(SLOPE_XYSERIES(self), cr);
     }
+  else if (priv->mode == SLOPE_SERIES_POINTS ||
+           priv->mode == SLOPE_SERIES_DENSITY)
+    {
+      _xyseries_draw_points(SLOPE_XYSERIES(self), cr);
+    }
+  _xybuffer_unref(pinned);
 }
 
 static void
@@ -175,24 +371,22 @@ _xyseries_draw_thumb (SlopeItem *self,
       cairo_line_to(cr, pos->x + 10.0, pos->y);
       cairo_stroke(cr);
     }
-  else if (priv->mode == SLOPE_SERIES_CIRCLES ||
-           priv->mode == SLOPE_SERIES_BIGCIRCLES)
-    {
-      cairo_set_line_width(cr, 1.1);
-      slope_cairo_circle (cr, &GRAPHENE_POINT_INIT (pos->x, pos->y), 4.5);
-      slope_cairo_draw (cr, &priv->symbol_stroke_color, &priv->symbol_fill_color);
-    }
-  else if (priv->mode == (SLOPE_SERIES_LINE | SLOPE_SERIES_CIRCLES) ||
-           priv->mode == (SLOPE_SERIES_LINE | SLOPE_SERIES_BIGCIRCLES))
+  else if (_xyseries_symbol_mode(priv->mode))
     {
       cairo_set_line_width(cr, 1.1);
-      slope_cairo_circle (cr, &GRAPHENE_POINT_INIT (pos->x, pos->y), 4.5);
+      if (priv->mode & SLOPE_SERIES_SQUARES)
+        cairo_rectangle(cr, pos->x - 4.5, pos->y - 4.5, 9.0, 9.0);
+      else
+        slope_cairo_circle (cr, &GRAPHENE_POINT_INIT (pos->x, pos->y), 4.5);
       slope_cairo_draw (cr, &priv->symbol_stroke_color, &priv->symbol_fill_color);
-      gdk_cairo_set_source_rgba (cr, &priv->line_color);
-      cairo_set_line_width(cr, priv->line_width);
-      cairo_move_to(cr, pos->x - 10.0, pos->y);
-      cairo_line_to(cr, pos->x + 10.0, pos->y);
-      cairo_stroke(cr);
+      if (priv->mode & SLOPE_SERIES_LINE)
+        {
+          gdk_cairo_set_source_rgba (cr, &priv->line_color);
+          cairo_set_line_width(cr, priv->line_width);
+          cairo_move_to(cr, pos->x - 10.0, pos->y);
+          cairo_line_to(cr, pos->x + 10.0, pos->y);
+          cairo_stroke(cr);
+        }
     }
   else if (priv->mode == SLOPE_SERIES_AREAUNDER)
     {
@@ -200,34 +394,333 @@ _xyseries_draw_thumb (SlopeItem *self,
       cairo_rectangle(cr, pos->x - 10.0, pos->y - 6.0, 20.0, 12.0);
       cairo_fill(cr);
     }
+  else if (priv->mode == SLOPE_SERIES_POINTS ||
+           priv->mode == SLOPE_SERIES_DENSITY)
+    {
+      gdk_cairo_set_source_rgba (cr, &priv->symbol_fill_color);
+      cairo_rectangle(cr, pos->x - 6.0, pos->y - 1.0, 2.0, 2.0);
+      cairo_rectangle(cr, pos->x - 1.0, pos->y + 1.0, 2.0, 2.0);
+      cairo_rectangle(cr, pos->x + 4.0, pos->y - 3.0, 2.0, 2.0);
+      cairo_fill(cr);
+    }
 }
 
-static void _xyseries_draw_line(SlopeXySeries *self, cairo_t *cr)
+static long _xyseries_lower_bound(const SlopeSamples *x, long lo, long hi, double v)
+{
+  /* first index in [lo, hi) with x >= v */
+  while (lo < hi)
+    {
+      long mid = lo + (hi - lo) / 2;
+      if (_samples_get(x, mid) < v)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+  return lo;
+}
+
+static long _xyseries_upper_bound(const SlopeSamples *x, long lo, long hi, double v)
+{
+  /* first index in [lo, hi) with x > v */
+  while (lo < hi)
+    {
+      long mid = lo + (hi - lo) / 2;
+      if (_samples_get(x, mid) <= v)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+  return lo;
+}
+
+static void _xyseries_visible_range(SlopeXySeries *self,
+                                    cairo_t *      cr,
+                                    long *         k_begin,
+                                    long *         k_end)
 {
   SlopeXySeriesPrivate *priv = slope_xyseries_get_instance_private (self);
   SlopeScale *          scale = slope_item_get_scale(SLOPE_ITEM(self));
-  graphene_point_t      p1, p2, p;
+  graphene_rect_t       dat_rect;
+  graphene_point_t      p1, p2;
+  double                x_min, x_max, fig_x1, fig_x2;
+  double                clip_x1, clip_y1, clip_x2, clip_y2;
+  long                  lo, hi;
+  *k_begin = 0L;
+  *k_end   = priv->n_pts;
+  if (priv->x_sorted_hint == FALSE && priv->x_sorted == FALSE)
+    {
+      return;
+    }
+  /* the data rect, in figure units */
+  slope_scale_get_data_rect (scale, &dat_rect);
+  x_min = graphene_rect_get_x (&dat_rect);
+  x_max = x_min + graphene_rect_get_width (&dat_rect);
+  slope_scale_map(scale, &p1, &GRAPHENE_POINT_INIT (x_min, graphene_rect_get_y (&dat_rect)));
+  slope_scale_map(scale, &p2, &GRAPHENE_POINT_INIT (x_max, graphene_rect_get_y (&dat_rect)));
+  /* a scrolled layer only redraws the uncovered strips, which
+   * it clips to, so the clip can narrow the range further */
+  cairo_clip_extents(cr, &clip_x1, &clip_y1, &clip_x2, &clip_y2);
+  fig_x1 = SLOPE_MAX(SLOPE_MIN(p1.x, p2.x), clip_x1);
+  fig_x2 = SLOPE_MIN(SLOPE_MAX(p1.x, p2.x), clip_x2);
+  /* markers centered just outside the plot or the clip still
+   * reach into them */
+  slope_scale_unmap(scale, &p1, &GRAPHENE_POINT_INIT (fig_x1 - XYSERIES_CLIP_MARGIN, clip_y1));
+  slope_scale_unmap(scale, &p2, &GRAPHENE_POINT_INIT (fig_x2 + XYSERIES_CLIP_MARGIN, clip_y1));
+  x_min = SLOPE_MIN(p1.x, p2.x);
+  x_max = SLOPE_MAX(p1.x, p2.x);
+  lo    = _xyseries_lower_bound(&priv->x, 0L, priv->n_pts, x_min);
+  hi    = _xyseries_upper_bound(&priv->x, lo, priv->n_pts, x_max);
+  /* keep one neighbour on each side so the segments that cross
+   * the scale borders are still drawn */
+  *k_begin = SLOPE_MAX(lo - 1L, 0L);
+  *k_end   = SLOPE_MIN(hi + 1L, priv->n_pts);
+}
+
+static long _xyseries_band_runs(SlopeXySeries *self,
+                                cairo_t *      cr,
+                                long           k_begin,
+                                long           k_end,
+                                long **        runs)
+{
+  SlopeXySeriesPrivate *priv = slope_xyseries_get_instance_private (self);
+  SlopeScale *          scale = slope_item_get_scale(SLOPE_ITEM(self));
+  SlopePyramid *        index = priv->lod;
+  graphene_rect_t       fig_rect;
+  graphene_point_t      clip_p1, clip_p2;
+  double                clip_x1, clip_y1, clip_x2, clip_y2;
+  double                margin, y_lo, y_hi;
+  long                  b, b_first, b_last, b_end, size;
+  long                  n_runs = 0L, n_alloc = 1L;
+  int                   side = 0;
+  *runs      = g_new(long, 2);
+  (*runs)[0] = k_begin;
+  (*runs)[1] = k_end;
+  /* only worth it when the clip leaves out most of the rows, as
+   * the bands of a PNG stream do */
+  slope_scale_get_figure_rect (scale, &fig_rect);
+  cairo_clip_extents(cr, &clip_x1, &clip_y1, &clip_x2, &clip_y2);
+  if (k_end - k_begin <= XYSERIES_BAND_BLOCK
+      || 2.0 * (clip_y2 - clip_y1) >= graphene_rect_get_height (&fig_rect))
+    {
+      return 1L;
+    }
+  if (priv->lod_valid == FALSE)
+    {
+      index = priv->band_index;
+      if (priv->band_index_valid == FALSE)
+        {
+          _pyramid_set_budget(index, 4 * sizeof(long)
+                              * (gsize)((priv->n_pts + XYSERIES_BAND_BLOCK - 1L)
+                                        / XYSERIES_BAND_BLOCK));
+          _pyramid_update(index, &priv->y, priv->n_pts, FALSE);
+          priv->band_index_valid = TRUE;
+        }
+    }
+  size = _pyramid_get_block_size(index);
+  if (size <= 0L)
+    {
+      return 1L;
+    }
+  /* as far as a marker or a miter joint reaches from its sample */
+  margin = XYSERIES_CLIP_MARGIN + priv->symbol_big_radius
+           + 0.5 * cairo_get_miter_limit(cr)
+                 * SLOPE_MAX(priv->line_width, priv->symbol_stroke_width);
+  slope_scale_unmap(scale, &clip_p1, &GRAPHENE_POINT_INIT (clip_x1, clip_y1 - margin));
+  slope_scale_unmap(scale, &clip_p2, &GRAPHENE_POINT_INIT (clip_x1, clip_y2 + margin));
+  y_lo  = SLOPE_MIN(clip_p1.y, clip_p2.y);
+  y_hi  = SLOPE_MAX(clip_p1.y, clip_p2.y);
+  b_end = (k_end + size - 1L) / size;
+  b     = _pyramid_next_block(index, k_begin / size, y_lo, y_hi, &side);
+  while (b < b_end)
+    {
+      /* consecutive blocks make a single run */
+      b_first = b;
+      do
+        {
+          b_last = b;
+          b      = _pyramid_next_block(index, b + 1L, y_lo, y_hi, &side);
+        }
+      while (b == b_last + 1L && b < b_end);
+      if (n_runs == n_alloc)
+        {
+          n_alloc *= 2L;
+          *runs = g_renew(long, *runs, 2 * n_alloc);
+        }
+      /* one more sample on each side for the segments that join
+       * the run to the blocks left out */
+      (*runs)[2 * n_runs]     = SLOPE_MAX(b_first * size - 1L, k_begin);
+      (*runs)[2 * n_runs + 1] = SLOPE_MIN((b_last + 1L) * size + 1L, k_end);
+      n_runs += 1L;
+    }
+  return n_runs;
+}
+
+static void _xyseries_add_line_path(SlopeXySeries *   self,
+                                    cairo_t *         cr,
+                                    long              k_begin,
+                                    long              k_end,
+                                    graphene_point_t *first,
+                                    graphene_point_t *last)
+{
+  SlopeXySeriesPrivate *priv = slope_xyseries_get_instance_private (self);
+  SlopeScale *          scale = slope_item_get_scale(SLOPE_ITEM(self));
+  graphene_point_t      buf[XYSERIES_MAP_CHUNK];
+  graphene_point_t      p1;
   double                dx, dy, d2;
-  long                  k;
-  p.x = priv->x_vec[0];
-  p.y = priv->y_vec[0];
-  slope_scale_map(scale, &p1, &p);
-  cairo_new_path(cr);
+  long                  k0, k, n, n_segments = 0L;
+  /* the blocks only match pixel columns when x is monotonic */
+  if (priv->lod_valid == TRUE
+      && (priv->x_sorted_hint == TRUE || priv->x_sorted == TRUE)
+      && _xyseries_add_lod_path(self, cr, k_begin, k_end, first, last))
+    {
+      return;
+    }
+  _samples_map(scale, first, &priv->x, &priv->y, k_begin, 1);
+  p1    = *first;
+  *last = p1;
+  /* an export at a given resolution has no use for more detail,
+   * and a series asking for a pyramid over unsorted x still wants
+   * its drawing bounded */
+  if (priv->decimate == TRUE || priv->lod_valid == TRUE
+      || _drawing_get_vector_resolution(cr) > 0.0)
+    {
+      /* keep only first/min/max/last of each pixel column */
+      SlopeDecimator decimator;
+      _decimator_begin(&decimator, cr);
+      _xyseries_push_range(self, &decimator, k_begin, k_end);
+      _samples_map(scale, last, &priv->x, &priv->y, k_end - 1, 1);
+      _decimator_end(&decimator);
+      _scale_count(scale, decimator.n_segments, 0L);
+      return;
+    }
   cairo_move_to(cr, p1.x, p1.y);
-  for (k = 1L; k < priv->n_pts; ++k)
-    {
-      p.x = priv->x_vec[k];
-      p.y = priv->y_vec[k];
-      slope_scale_map(scale, &p2, &p);
-      dx = p2.x - p1.x;
-      dy = p2.y - p1.y;
-      d2 = dx * dx + dy * dy;
-      if (d2 >= 9.0)
+  for (k0 = k_begin + 1L; k0 < k_end; k0 += n)
+    {
+      n = SLOPE_MIN(k_end - k0, XYSERIES_MAP_CHUNK);
+      _samples_map(scale, buf, &priv->x, &priv->y, k0, n);
+      for (k = 0L; k < n; ++k)
         {
-          cairo_line_to(cr, p2.x, p2.y);
-          p1 = p2;
+          dx = buf[k].x - p1.x;
+          dy = buf[k].y - p1.y;
+          d2 = dx * dx + dy * dy;
+          if (d2 >= 9.0)
+            {
+              cairo_line_to(cr, buf[k].x, buf[k].y);
+              p1 = buf[k];
+              n_segments += 1L;
+            }
         }
+      *last = buf[n - 1];
     }
+  _scale_count(scale, n_segments, 0L);
+}
+
+static void _xyseries_push_range(SlopeXySeries * self,
+                                 SlopeDecimator *decimator,
+                                 long            k_begin,
+                                 long            k_end)
+{
+  SlopeXySeriesPrivate *priv = slope_xyseries_get_instance_private (self);
+  SlopeScale *          scale = slope_item_get_scale(SLOPE_ITEM(self));
+  graphene_point_t      buf[XYSERIES_MAP_CHUNK];
+  long                  k0, k, n;
+  for (k0 = k_begin; k0 < k_end; k0 += n)
+    {
+      n = SLOPE_MIN(k_end - k0, XYSERIES_MAP_CHUNK);
+      _samples_map(scale, buf, &priv->x, &priv->y, k0, n);
+      for (k = 0L; k < n; ++k)
+        {
+          _decimator_push(decimator, &buf[k]);
+        }
+    }
+}
+
+static gboolean _xyseries_add_lod_path(SlopeXySeries *   self,
+                                       cairo_t *         cr,
+                                       long              k_begin,
+                                       long              k_end,
+                                       graphene_point_t *first,
+                                       graphene_point_t *last)
+{
+  SlopeXySeriesPrivate *   priv = slope_xyseries_get_instance_private (self);
+  SlopeScale *             scale = slope_item_get_scale(SLOPE_ITEM(self));
+  const SlopePyramidLevel *level;
+  SlopeDecimator           decimator;
+  graphene_rect_t          fig_rect;
+  graphene_point_t         buf[XYSERIES_MAP_CHUNK];
+  double                   x_buf[XYSERIES_MAP_CHUNK];
+  double                   y_buf[XYSERIES_MAP_CHUNK];
+  double                   n_pixels, dy = 0.0;
+  long                     b, b_begin, b_end, k, n = 0L;
+  long                     head_end, tail_begin;
+
+  slope_scale_get_figure_rect (scale, &fig_rect);
+  n_pixels = graphene_rect_get_width (&fig_rect);
+  cairo_user_to_device_distance(cr, &n_pixels, &dy);
+  n_pixels = fabs(n_pixels) / _drawing_get_column_width(cr);
+  level = _pyramid_select_level(priv->lod, k_end - k_begin, (long) n_pixels);
+  if (level == NULL)
+    {
+      /* the data is already sparse enough for the raw path */
+      return FALSE;
+    }
+
+  /* only whole blocks inside the range use the summaries, the
+   * partial ones at the borders are sent sample by sample */
+  b_begin = (k_begin + level->block_size - 1) / level->block_size;
+  b_end   = (k_end == priv->n_pts) ? level->n_blocks : k_end / level->block_size;
+  if (b_end < b_begin)
+    {
+      b_end = b_begin;
+    }
+
+  _samples_map(scale, first, &priv->x, &priv->y, k_begin, 1);
+  _decimator_begin(&decimator, cr);
+  _decimator_push(&decimator, first);
+  head_end   = SLOPE_MIN(b_begin * level->block_size, k_end);
+  tail_begin = SLOPE_MAX(b_end * level->block_size, head_end);
+  _xyseries_push_range(self, &decimator, k_begin + 1L, head_end);
+  for (b = b_begin; b < b_end; ++b)
+    {
+      /* the block extremes are real samples, visit them in order */
+      long k1 = SLOPE_MIN(level->min_idx[b], level->max_idx[b]);
+      long k2 = SLOPE_MAX(level->min_idx[b], level->max_idx[b]);
+      x_buf[n]   = _samples_get(&priv->x, k1);
+      y_buf[n++] = _samples_get(&priv->y, k1);
+      x_buf[n]   = _samples_get(&priv->x, k2);
+      y_buf[n++] = _samples_get(&priv->y, k2);
+      if (n == XYSERIES_MAP_CHUNK || b == b_end - 1)
+        {
+          slope_scale_map_array(scale, buf, x_buf, y_buf, n);
+          for (k = 0L; k < n; ++k)
+            {
+              _decimator_push(&decimator, &buf[k]);
+            }
+          n = 0L;
+        }
+    }
+  _xyseries_push_range(self, &decimator, tail_begin, k_end);
+  _samples_map(scale, last, &priv->x, &priv->y, k_end - 1, 1);
+  _decimator_push(&decimator, last);
+  _decimator_end(&decimator);
+  _scale_count(scale, decimator.n_segments, 0L);
+  return TRUE;
+}
+
+static void _xyseries_draw_line(SlopeXySeries *self, cairo_t *cr)
+{
+  SlopeXySeriesPrivate *priv = slope_xyseries_get_instance_private (self);
+  graphene_point_t      first, last;
+  long *                runs;
+  long                  k_begin, k_end, n_runs, r;
+  _xyseries_visible_range(self, cr, &k_begin, &k_end);
+  n_runs = _xyseries_band_runs(self, cr, k_begin, k_end, &runs);
+  cairo_new_path(cr);
+  for (r = 0L; r < n_runs; ++r)
+    {
+      _xyseries_add_line_path(self, cr, runs[2 * r], runs[2 * r + 1], &first, &last);
+    }
+  g_free(runs);
   cairo_set_line_width(cr, priv->line_width);
   gdk_cairo_set_source_rgba (cr, &priv->symbol_stroke_color);
   cairo_stroke(cr);
@@ -238,36 +731,22 @@ static void _xyseries_draw_areaunder(SlopeXySeries *self, cairo_t *cr)
   SlopeXySeriesPrivate *priv = slope_xyseries_get_instance_private (self);
   SlopeScale *          scale = slope_item_get_scale(SLOPE_ITEM(self));
   cairo_path_t *        data_path;
-  graphene_point_t      p1, p2, p0, p;
-  double                dx, dy, d2;
-  long                  k;
-  p.x = priv->x_vec[0];
-  p.y = priv->y_vec[0];
-  slope_scale_map(scale, &p1, &p);
+  graphene_point_t      first, last, p0, p;
+  long                  k_begin, k_end;
+  /* the fill reaches down to the x axis, so it is never culled to
+   * a band of rows */
+  _xyseries_visible_range(self, cr, &k_begin, &k_end);
   cairo_new_path(cr);
-  cairo_move_to(cr, p1.x, p1.y);
+  _xyseries_add_line_path(self, cr, k_begin, k_end, &first, &last);
   /* keep track of the first point x and where the
    * x axis (y=0) is */
+  p.x = _samples_get(&priv->x, k_begin);
   p.y = 0.0;
   slope_scale_map(scale, &p0, &p);
-  for (k = 1L; k < priv->n_pts; ++k)
-    {
-      p.x = priv->x_vec[k];
-      p.y = priv->y_vec[k];
-      slope_scale_map(scale, &p2, &p);
-      dx = p2.x - p1.x;
-      dy = p2.y - p1.y;
-      d2 = dx * dx + dy * dy;
-      if (d2 >= 9.0)
-        {
-          cairo_line_to(cr, p2.x, p2.y);
-          p1 = p2;
-        }
-    }
   data_path = cairo_copy_path(cr);
   cairo_set_line_width(cr, priv->line_width);
   /* complete the closed path to fill */
-  cairo_line_to(cr, p2.x, p0.y);
+  cairo_line_to(cr, last.x, p0.y);
   cairo_line_to(cr, p0.x, p0.y);
   cairo_close_path(cr);
   gdk_cairo_set_source_rgba (cr, &priv->symbol_fill_color);
@@ -279,25 +758,167 @@ static void _xyseries_draw_areaunder(SlopeXySeries *self, cairo_t *cr)
   cairo_path_destroy(data_path);
 }
 
-static void _xyseries_draw_circles(SlopeXySeries *self, cairo_t *cr)
+static gboolean _xyseries_symbol_mode(int mode)
+{
+  /* circles or squares of any size, optionally joined by a line */
+  int symbol = mode & ~(SLOPE_SERIES_LINE | SLOPE_SERIES_BIGSYMBOL);
+  return symbol == SLOPE_SERIES_CIRCLES || symbol == SLOPE_SERIES_SQUARES;
+}
+
+static void _xyseries_draw_symbols(SlopeXySeries *self, cairo_t *cr)
 {
   SlopeXySeriesPrivate *priv = slope_xyseries_get_instance_private (self);
   SlopeScale *          scale = slope_item_get_scale(SLOPE_ITEM(self));
-  graphene_point_t      dat_p, fig_p;
+  graphene_point_t      buf[XYSERIES_MAP_CHUNK];
+  SlopeStampShape       shape;
+  gboolean              stamped;
+  double                radius;
+  long *                runs;
+  long                  k_begin, k_end, k0, k, n, n_runs, r, n_markers = 0L;
+  _xyseries_visible_range(self, cr, &k_begin, &k_end);
+  n_runs = _xyseries_band_runs(self, cr, k_begin, k_end, &runs);
   cairo_set_line_width(cr, priv->line_width);
-  long k;
-  for (k = 0L; k < priv->n_pts; ++k)
-    {
-      fig_p.x = priv->x_vec[k];
-      fig_p.y = priv->y_vec[k];
-      slope_scale_map(scale, &dat_p, &fig_p);
-      slope_cairo_circle(cr,
-                         &dat_p,
-                         (priv->mode & SLOPE_SERIES_BIGSYMBOL)
-                             ? priv->symbol_big_radius
-                             : priv->symbol_small_radius);
-      slope_cairo_draw (cr, &priv->symbol_stroke_color, &priv->symbol_fill_color);
+  radius = (priv->mode & SLOPE_SERIES_BIGSYMBOL) ? priv->symbol_big_radius
+                                                 : priv->symbol_small_radius;
+  shape  = (priv->mode & SLOPE_SERIES_SQUARES) ? SLOPE_STAMP_SQUARE
+                                               : SLOPE_STAMP_CIRCLE;
+  stamped = _stamp_begin(priv->stamp,
+                         cr,
+                         shape,
+                         radius,
+                         priv->line_width,
+                         &priv->symbol_stroke_color,
+                         &priv->symbol_fill_color,
+                         priv->antialias);
+  for (r = 0L; r < n_runs; ++r)
+    {
+      k_begin = runs[2 * r];
+      k_end   = runs[2 * r + 1];
+      for (k0 = k_begin; k0 < k_end; k0 += n)
+        {
+          n = SLOPE_MIN(k_end - k0, XYSERIES_MAP_CHUNK);
+          _samples_map(scale, buf, &priv->x, &priv->y, k0, n);
+          for (k = 0L; k < n; ++k)
+            {
+              if (stamped)
+                {
+                  _stamp_draw(priv->stamp, cr, &buf[k]);
+                  continue;
+                }
+              /* vector output keeps real paths */
+              if (shape == SLOPE_STAMP_SQUARE)
+                cairo_rectangle(cr, buf[k].x - radius, buf[k].y - radius,
+                                2.0 * radius, 2.0 * radius);
+              else
+                slope_cairo_circle(cr, &buf[k], radius);
+              slope_cairo_draw (cr, &priv->symbol_stroke_color, &priv->symbol_fill_color);
+            }
+        }
+      n_markers += k_end - k_begin;
+    }
+  g_free(runs);
+  if (stamped)
+    {
+      _stamp_end(priv->stamp, cr);
+    }
+  _scale_count(scale, 0L, n_markers);
+}
+
+static void _xyseries_draw_points(SlopeXySeries *self, cairo_t *cr)
+{
+  SlopeXySeriesPrivate *priv = slope_xyseries_get_instance_private (self);
+  SlopeScale *          scale = slope_item_get_scale(SLOPE_ITEM(self));
+  graphene_point_t      buf[XYSERIES_MAP_CHUNK];
+  graphene_rect_t       fig_rect;
+  guint8 *              cells = NULL;
+  double                size, dummy = 0.0;
+  long *                runs;
+  long                  n_cols = 0L, n_rows = 0L, col, row;
+  long                  k_begin, k_end, k0, k, n, n_runs, r, n_markers = 0L;
+  _xyseries_visible_range(self, cr, &k_begin, &k_end);
+  if (priv->mode == SLOPE_SERIES_DENSITY)
+    {
+      /* the density is relative to the most hit pixel of the whole
+       * plot, every band has to see all the points */
+      runs    = g_new(long, 2);
+      runs[0] = k_begin;
+      runs[1] = k_end;
+      n_runs  = 1L;
+    }
+  else
+    {
+      n_runs = _xyseries_band_runs(self, cr, k_begin, k_end, &runs);
+    }
+  if (_raster_draw_points(cr,
+                          scale,
+                          &priv->x,
+                          &priv->y,
+                          runs,
+                          n_runs,
+                          (priv->mode == SLOPE_SERIES_DENSITY)
+                              ? SLOPE_RASTER_DENSITY
+                              : SLOPE_RASTER_POINTS,
+                          &priv->symbol_fill_color))
+    {
+      for (r = 0L; r < n_runs; ++r)
+        {
+          n_markers += runs[2 * r + 1] - runs[2 * r];
+        }
+      g_free(runs);
+      _scale_count(scale, 0L, n_markers);
+      return;
+    }
+  /* vector output: one device pixel sized square per point, all
+   * filled at once */
+  size = _drawing_get_column_width(cr);
+  cairo_device_to_user_distance(cr, &size, &dummy);
+  size = fabs(size);
+  if (_drawing_get_vector_resolution(cr) > 0.0 && size > 0.0)
+    {
+      /* for an export at a given resolution, only the first point
+       * landing on each of its dots is kept */
+      slope_scale_get_figure_rect (scale, &fig_rect);
+      n_cols = (long) ceil(graphene_rect_get_width (&fig_rect) / size);
+      n_rows = (long) ceil(graphene_rect_get_height (&fig_rect) / size);
+      if (n_cols > 0L && n_rows > 0L && n_cols <= XYSERIES_MAX_POINT_CELLS / n_rows)
+        {
+          cells = g_new0(guint8, n_cols * n_rows);
+        }
+    }
+  cairo_new_path(cr);
+  for (r = 0L; r < n_runs; ++r)
+    {
+      k_begin = runs[2 * r];
+      k_end   = runs[2 * r + 1];
+      for (k0 = k_begin; k0 < k_end; k0 += n)
+        {
+          n = SLOPE_MIN(k_end - k0, XYSERIES_MAP_CHUNK);
+          _samples_map(scale, buf, &priv->x, &priv->y, k0, n);
+          for (k = 0L; k < n; ++k)
+            {
+              if (cells != NULL)
+                {
+                  col = (long) floor((buf[k].x - graphene_rect_get_x (&fig_rect)) / size);
+                  row = (long) floor((buf[k].y - graphene_rect_get_y (&fig_rect)) / size);
+                  if (col >= 0L && col < n_cols && row >= 0L && row < n_rows)
+                    {
+                      if (cells[row * n_cols + col])
+                        {
+                          continue;
+                        }
+                      cells[row * n_cols + col] = 1;
+                    }
+                }
+              cairo_rectangle(cr, buf[k].x - 0.5 * size, buf[k].y - 0.5 * size, size, size);
+              n_markers += 1L;
+            }
+        }
     }
+  g_free(runs);
+  g_free(cells);
+  _scale_count(scale, 0L, n_markers);
+  gdk_cairo_set_source_rgba (cr, &priv->symbol_fill_color);
+  cairo_fill(cr);
 }
 
 static void
@@ -315,26 +936,258 @@ _xyseries_get_data_rect (SlopeItem *self, graphene_rect_t *rect)
                       priv->x_max - priv->x_min, priv->y_max - priv->y_min);
 }
 
+static void _xyseries_update_call(const SlopeFigureCall *call)
+{
+  slope_xyseries_update(call->object);
+}
+
 void slope_xyseries_update(SlopeXySeries *self)
+{
+  SlopeFigure *   figure = _figure_of_scale(slope_item_get_scale(SLOPE_ITEM(self)));
+  SlopeFigureCall call   = {.object = self};
+  if (_figure_begin_change(figure, _xyseries_update_call, &call))
+    {
+      _xyseries_scan(self, FALSE);
+      _figure_end_change(figure);
+    }
+}
+
+static void _xyseries_append_call(const SlopeFigureCall *call)
+{
+  slope_xyseries_append(call->object, call->n);
+}
+
+void slope_xyseries_append(SlopeXySeries *self, long n_pts)
+{
+  SlopeXySeriesPrivate *priv   = slope_xyseries_get_instance_private (self);
+  SlopeFigure *         figure = _figure_of_scale(slope_item_get_scale(SLOPE_ITEM(self)));
+  SlopeFigureCall       call   = {.object = self, .n = n_pts};
+  g_return_if_fail(priv->front == NULL);
+  g_return_if_fail(n_pts >= priv->n_pts);
+  if (!_figure_begin_change(figure, _xyseries_append_call, &call))
+    {
+      return;
+    }
+  priv->n_pts = n_pts;
+  _xyseries_scan(self, TRUE);
+  _figure_end_change(figure);
+}
+
+static void _xyseries_scan(SlopeXySeries *self, gboolean append)
 {
   SlopeXySeriesPrivate *priv = slope_xyseries_get_instance_private (self);
-  SlopeScale *          scale = slope_item_get_scale(SLOPE_ITEM(self));
-  const double *        x     = priv->x_vec;
-  const double *        y     = priv->y_vec;
-  priv->x_min = priv->x_max = x[0];
-  priv->y_min = priv->y_max = y[0];
-  long k;
-  for (k = 1L; k < priv->n_pts; ++k)
-    {
-      if (x[k] < priv->x_min) priv->x_min = x[k];
-      if (x[k] > priv->x_max) priv->x_max = x[k];
-      if (y[k] < priv->y_min) priv->y_min = y[k];
-      if (y[k] > priv->y_max) priv->y_max = y[k];
+  long                  first_pt = 0L;
+  /* only an append may trust the samples scanned before */
+  if (append && priv->bounds_n_pts > 0L && _samples_equal(&priv->x, &priv->bounds_x)
+      && _samples_equal(&priv->y, &priv->bounds_y) && priv->n_pts >= priv->bounds_n_pts)
+    {
+      first_pt = priv->bounds_n_pts;
+    }
+  else
+    {
+      _simd_bounds_reset(&priv->bounds);
     }
+  _samples_bounds_scan(&priv->bounds, &priv->x, &priv->y, first_pt, priv->n_pts);
+  priv->bounds_x     = priv->x;
+  priv->bounds_y     = priv->y;
+  priv->bounds_n_pts = priv->n_pts;
+  _simd_bounds_finish(&priv->bounds,
+                      &priv->x_min,
+                      &priv->x_max,
+                      &priv->y_min,
+                      &priv->y_max,
+                      &priv->x_sorted);
+  _xyseries_data_changed(self, append);
+}
+
+static void _xyseries_data_changed(SlopeXySeries *self, gboolean append)
+{
+  SlopeXySeriesPrivate *priv = slope_xyseries_get_instance_private (self);
+  SlopeScale *          scale = slope_item_get_scale(SLOPE_ITEM(self));
+  _pyramid_update(priv->lod, &priv->y, priv->n_pts, append);
+  priv->lod_valid = (_pyramid_get_budget(priv->lod) > 0);
+  priv->band_index_valid = FALSE;
+  slope_item_invalidate(SLOPE_ITEM(self));
   if (scale != NULL)
     {
-      slope_scale_rescale(scale);
+      _scale_data_changed(scale);
+    }
+}
+
+static void _xyseries_recycle(SlopeXySeries *self, SlopeXyBuffer *buffer)
+{
+  SlopeXySeriesPrivate *priv = slope_xyseries_get_instance_private (self);
+  if (_xybuffer_is_exclusive(buffer))
+    {
+      /* nobody draws from it anymore, the writer may reuse it */
+      _xybuffer_unref(g_atomic_pointer_exchange(&priv->spare, buffer));
     }
+  else
+    {
+      _xybuffer_unref(buffer);
+    }
+}
+
+gboolean slope_xyseries_begin_write(SlopeXySeries *self,
+                                    long           n_pts,
+                                    double **      x_vec,
+                                    double **      y_vec)
+{
+  SlopeXySeriesPrivate *priv = slope_xyseries_get_instance_private (self);
+  SlopeXyBuffer *       buffer;
+  g_return_val_if_fail(priv->back == NULL, FALSE);
+  g_return_val_if_fail(n_pts > 0L, FALSE);
+  /* prefer a buffer the main thread is done with, then one that
+   * was published but not drawn yet (it is superseded anyway) */
+  buffer = g_atomic_pointer_exchange(&priv->spare, NULL);
+  if (buffer == NULL)
+    {
+      buffer = g_atomic_pointer_exchange(&priv->pending, NULL);
+    }
+  if (buffer == NULL)
+    {
+      buffer = _xybuffer_new();
+    }
+  _xybuffer_reserve(buffer, n_pts);
+  priv->back = buffer;
+  *x_vec     = buffer->x_vec;
+  *y_vec     = buffer->y_vec;
+  return TRUE;
+}
+
+guint slope_xyseries_end_write(SlopeXySeries *self)
+{
+  SlopeXySeriesPrivate *priv = slope_xyseries_get_instance_private (self);
+  SlopeXyBuffer *       buffer = priv->back;
+  SlopeXyBuffer *       superseded;
+  g_return_val_if_fail(buffer != NULL, 0);
+  /* the O(n) scan runs here, on the writer thread */
+  _xybuffer_update_bounds(buffer);
+  buffer->epoch = (guint) g_atomic_int_add(&priv->write_epoch, 1) + 1;
+  priv->back    = NULL;
+  superseded    = g_atomic_pointer_exchange(&priv->pending, buffer);
+  if (superseded != NULL)
+    {
+      /* never seen by the main thread, recycle it directly */
+      _xybuffer_unref(g_atomic_pointer_exchange(&priv->spare, superseded));
+    }
+  _item_schedule_redraw(SLOPE_ITEM(self));
+  return buffer->epoch;
+}
+
+guint slope_xyseries_get_epoch(SlopeXySeries *self)
+{
+  SlopeXySeriesPrivate *priv = slope_xyseries_get_instance_private (self);
+  return priv->epoch;
+}
+
+static void _xyseries_sync(SlopeItem *self)
+{
+  SlopeXySeriesPrivate *priv = slope_xyseries_get_instance_private (SLOPE_XYSERIES (self));
+  SlopeXyBuffer *       buffer = g_atomic_pointer_exchange(&priv->pending, NULL);
+  if (buffer == NULL)
+    {
+      return;
+    }
+  if (priv->front != NULL)
+    {
+      _xyseries_recycle(SLOPE_XYSERIES(self), priv->front);
+    }
+  priv->front     = buffer;
+  priv->epoch     = buffer->epoch;
+  _samples_init(&priv->x, buffer->x_vec, SLOPE_SAMPLE_DOUBLE, 1.0, 0.0);
+  _samples_init(&priv->y, buffer->y_vec, SLOPE_SAMPLE_DOUBLE, 1.0, 0.0);
+  priv->n_pts     = buffer->n_pts;
+  priv->x_min     = buffer->x_min;
+  priv->x_max     = buffer->x_max;
+  priv->y_min     = buffer->y_min;
+  priv->y_max     = buffer->y_max;
+  priv->x_sorted  = buffer->x_sorted;
+  priv->lod_valid = FALSE;
+  /* recycled buffers come back with the same addresses */
+  priv->bounds_n_pts = 0L;
+  _xyseries_data_changed(SLOPE_XYSERIES(self), FALSE);
+}
+
+static void _xyseries_set_decimate_call(const SlopeFigureCall *call)
+{
+  slope_xyseries_set_decimate(call->object, call->i[0]);
+}
+
+void slope_xyseries_set_decimate(SlopeXySeries *self, gboolean decimate)
+{
+  SlopeXySeriesPrivate *priv   = slope_xyseries_get_instance_private (self);
+  SlopeFigure *         figure = _figure_of_scale(slope_item_get_scale(SLOPE_ITEM(self)));
+  SlopeFigureCall       call   = {.object = self, .i = {decimate}};
+  if (!_figure_begin_change(figure, _xyseries_set_decimate_call, &call))
+    {
+      return;
+    }
+  priv->decimate = decimate;
+  slope_item_invalidate(SLOPE_ITEM(self));
+  _figure_end_change(figure);
+}
+
+gboolean slope_xyseries_get_decimate(SlopeXySeries *self)
+{
+  SlopeXySeriesPrivate *priv = slope_xyseries_get_instance_private (self);
+  return priv->decimate;
+}
+
+static void _xyseries_set_lod_budget_call(const SlopeFigureCall *call)
+{
+  slope_xyseries_set_lod_budget(call->object, (gsize) call->n);
+}
+
+void slope_xyseries_set_lod_budget(SlopeXySeries *self, gsize budget)
+{
+  SlopeXySeriesPrivate *priv   = slope_xyseries_get_instance_private (self);
+  SlopeFigure *         figure = _figure_of_scale(slope_item_get_scale(SLOPE_ITEM(self)));
+  SlopeFigureCall       call   = {.object = self, .n = (long) budget};
+  if (!_figure_begin_change(figure, _xyseries_set_lod_budget_call, &call))
+    {
+      return;
+    }
+  _pyramid_set_budget(priv->lod, budget);
+  priv->lod_valid = FALSE;
+  if (budget > 0 && priv->n_pts > 0L)
+    {
+      _pyramid_update(priv->lod, &priv->y, priv->n_pts, FALSE);
+      priv->lod_valid = TRUE;
+    }
+  slope_item_invalidate(SLOPE_ITEM(self));
+  _figure_end_change(figure);
+}
+
+gsize slope_xyseries_get_lod_budget(SlopeXySeries *self)
+{
+  SlopeXySeriesPrivate *priv = slope_xyseries_get_instance_private (self);
+  return _pyramid_get_budget(priv->lod);
+}
+
+static void _xyseries_set_x_sorted_call(const SlopeFigureCall *call)
+{
+  slope_xyseries_set_x_sorted(call->object, call->i[0]);
+}
+
+void slope_xyseries_set_x_sorted(SlopeXySeries *self, gboolean sorted)
+{
+  SlopeXySeriesPrivate *priv   = slope_xyseries_get_instance_private (self);
+  SlopeFigure *         figure = _figure_of_scale(slope_item_get_scale(SLOPE_ITEM(self)));
+  SlopeFigureCall       call   = {.object = self, .i = {sorted}};
+  if (!_figure_begin_change(figure, _xyseries_set_x_sorted_call, &call))
+    {
+      return;
+    }
+  priv->x_sorted_hint = sorted;
+  slope_item_invalidate(SLOPE_ITEM(self));
+  _figure_end_change(figure);
+}
+
+gboolean slope_xyseries_get_x_sorted(SlopeXySeries *self)
+{
+  SlopeXySeriesPrivate *priv = slope_xyseries_get_instance_private (self);
+  return priv->x_sorted_hint || priv->x_sorted;
 }
 
 int _xyseries_parse_mode(const char *c)
@@ -352,11 +1205,31 @@ int _xyseries_parse_mode(const char *c)
         mode = SLOPE_SERIES_BIGCIRCLES;
       }
       break;
+    case 's':
+      {
+        mode = SLOPE_SERIES_SQUARES;
+      }
+      break;
+    case 'S':
+      {
+        mode = SLOPE_SERIES_BIGSQUARES;
+      }
+      break;
     case 'a':
       {
         mode = SLOPE_SERIES_AREAUNDER;
       }
       break;
+    case '.':
+      {
+        mode = SLOPE_SERIES_POINTS;
+      }
+      break;
+    case ':':
+      {
+        mode = SLOPE_SERIES_DENSITY;
+      }
+      break;
     case '-':
       {
         mode = SLOPE_SERIES_LINE;
@@ -374,6 +1247,16 @@ int _xyseries_parse_mode(const char *c)
                   mode |= SLOPE_SERIES_BIGCIRCLES;
                 }
                 break;
+              case 's':
+                {
+                  mode |= SLOPE_SERIES_SQUARES;
+                }
+                break;
+              case 'S':
+                {
+                  mode |= SLOPE_SERIES_BIGSQUARES;
+                }
+                break;
               case 'a':
                 {
                   mode |= SLOPE_SERIES_AREAUNDER;
@@ -416,6 +1299,11 @@ _xyseries_color_parse (char c)
   return "BLACK";
 }
 
+static void _xyseries_set_style_call(const SlopeFigureCall *call)
+{
+  slope_xyseries_set_style(call->object, call->p[0]);
+}
+
 void slope_xyseries_set_style(SlopeXySeries *self, const char *style)
 {
   SlopeXySeriesPrivate *priv = slope_xyseries_get_instance_private (self);
@@ -424,6 +1312,10 @@ void slope_xyseries_set_style(SlopeXySeries *self, const char *style)
   double                line_width          = 1.5;
   double                symbol_stroke_width = 1.0;
   int                   mode = SLOPE_SERIES_LINE, k = 0;
+  SlopeFigure *         figure = _figure_of_scale(slope_item_get_scale(SLOPE_ITEM(self)));
+  SlopeFigureCall       call   = {.object = self,
+                                  .p      = {(gpointer) style},
+                                  .p_size = (style != NULL) ? strlen(style) + 1 : 0};
   /* parse the stroke and fill colors */
   if (style != NULL && style[k] != '\0')
     {
@@ -456,6 +1348,10 @@ void slope_xyseries_set_style(SlopeXySeries *self, const char *style)
         }
     }
 
+  if (!_figure_begin_change(figure, _xyseries_set_style_call, &call))
+    {
+      return;
+    }
   priv->mode                = mode;
   gdk_rgba_parse (&priv->line_color, stroke_color_name);
   gdk_rgba_parse (&priv->symbol_fill_color, fill_color_name);
@@ -471,6 +1367,8 @@ void slope_xyseries_set_style(SlopeXySeries *self, const char *style)
 
   priv->line_width          = line_width;
   priv->symbol_stroke_width = symbol_stroke_width;
+  slope_item_invalidate(SLOPE_ITEM(self));
+  _figure_end_change(figure);
 }
 
 /* slope/xyseries.c */
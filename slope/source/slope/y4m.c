@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2017,2023  Elvis Teixeira, Anatoliy Sokolov
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <slope/y4m_p.h>
+
+struct _SlopeY4mWriter
+{
+  cairo_write_func_t write_func;
+  void *             closure;
+  int                width;
+  int                height;
+  int                chroma_width;
+  int                chroma_height;
+  /* the Y, Cb and Cr planes of a frame, one after the other */
+  unsigned char *    planes;
+  gsize              planes_size;
+  cairo_status_t     status;
+};
+
+static void _y4m_write(SlopeY4mWriter *self, const unsigned char *data, gsize size)
+{
+  if (self->status == CAIRO_STATUS_SUCCESS)
+    {
+      self->status = self->write_func(self->closure, data, (unsigned int) size);
+    }
+}
+
+SlopeY4mWriter *_y4m_writer_new(cairo_write_func_t write_func,
+                                void *             closure,
+                                int                width,
+                                int                height,
+                                double             fps)
+{
+  SlopeY4mWriter *self = g_new(SlopeY4mWriter, 1);
+  char            header[128];
+  int             length;
+
+  self->write_func    = write_func;
+  self->closure       = closure;
+  self->width         = width;
+  self->height        = height;
+  self->chroma_width  = (width + 1) / 2;
+  self->chroma_height = (height + 1) / 2;
+  self->planes_size   = (gsize) width * height
+                      + 2 * (gsize) self->chroma_width * self->chroma_height;
+  self->planes        = g_malloc(self->planes_size);
+  self->status        = CAIRO_STATUS_SUCCESS;
+
+  /* the frame rate goes as a fraction, in thousandths. Readers
+     take y4m as limited range unless told otherwise, say it anyway */
+  length = g_snprintf(header, sizeof(header),
+                      "YUV4MPEG2 W%d H%d F%ld:1000 Ip A1:1 C420jpeg XCOLORRANGE=LIMITED\n",
+                      width, height, lround(fps * 1000.0));
+  _y4m_write(self, (const unsigned char *) header, (gsize) length);
+  return self;
+}
+
+cairo_status_t _y4m_writer_write_frame(SlopeY4mWriter *self, cairo_surface_t *image)
+{
+  static const unsigned char frame_header[] = "FRAME\n";
+  const unsigned char *      data;
+  unsigned char *            y_plane  = self->planes;
+  unsigned char *            cb_plane = y_plane + (gsize) self->width * self->height;
+  unsigned char *            cr_plane = cb_plane + (gsize) self->chroma_width * self->chroma_height;
+  int                        stride, row, col, dr, dc;
+
+  cairo_surface_flush(image);
+  data   = cairo_image_surface_get_data(image);
+  stride = cairo_image_surface_get_stride(image);
+  for (row = 0; row < self->height; ++row)
+    {
+      const guint32 *src = (const guint32 *) (data + (gsize) row * stride);
+      for (col = 0; col < self->width; ++col)
+        {
+          /* premultiplied, so this is the colour over black */
+          int r = (src[col] >> 16) & 0xff;
+          int g = (src[col] >> 8) & 0xff;
+          int b = src[col] & 0xff;
+          y_plane[(gsize) row * self->width + col] =
+              (unsigned char) (16 + ((16829 * r + 33039 * g + 6416 * b + 32768) >> 16));
+        }
+    }
+  /* each chroma sample is the mean of a 2x2 block */
+  for (row = 0; row < self->chroma_height; ++row)
+    {
+      for (col = 0; col < self->chroma_width; ++col)
+        {
+          int r = 0, g = 0, b = 0, n = 0, cb, cr;
+          for (dr = 0; dr < 2 && 2 * row + dr < self->height; ++dr)
+            {
+              const guint32 *src = (const guint32 *) (data + (gsize) (2 * row + dr) * stride);
+              for (dc = 0; dc < 2 && 2 * col + dc < self->width; ++dc)
+                {
+                  guint32 pixel = src[2 * col + dc];
+                  r += (pixel >> 16) & 0xff;
+                  g += (pixel >> 8) & 0xff;
+                  b += pixel & 0xff;
+                  n += 1;
+                }
+            }
+          r /= n;
+          g /= n;
+          b /= n;
+          cb = 128 + ((-9714 * r - 19071 * g + 28784 * b + 32768) >> 16);
+          cr = 128 + ((28784 * r - 24103 * g - 4681 * b + 32768) >> 16);
+          cb_plane[(gsize) row * self->chroma_width + col] = (unsigned char) CLAMP(cb, 16, 240);
+          cr_plane[(gsize) row * self->chroma_width + col] = (unsigned char) CLAMP(cr, 16, 240);
+        }
+    }
+  _y4m_write(self, frame_header, sizeof(frame_header) - 1);
+  _y4m_write(self, self->planes, self->planes_size);
+  return self->status;
+}
+
+cairo_status_t _y4m_writer_finish(SlopeY4mWriter *self)
+{
+  cairo_status_t status = self->status;
+  g_free(self->planes);
+  g_free(self);
+  return status;
+}
+
+/* slope/y4m.c */
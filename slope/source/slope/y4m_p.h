@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2017,2023  Elvis Teixeira, Anatoliy Sokolov
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SLOPE_Y4M_P_H
+#define SLOPE_Y4M_P_H
+
+#include <slope/drawing.h>
+
+/* YUV4MPEG2 stream writer, 4:2:0 limited range BT.601 (luma in
+ * 16-235, chroma in 16-240), the raw format video encoders read
+ * from a pipe. */
+typedef struct _SlopeY4mWriter SlopeY4mWriter;
+
+/* Writes the stream header right away */
+SlopeY4mWriter *_y4m_writer_new(cairo_write_func_t write_func,
+                                void *             closure,
+                                int                width,
+                                int                height,
+                                double             fps);
+
+/* Appends the contents of an ARGB32 image of the writer's size,
+ * transparent parts come out black */
+cairo_status_t _y4m_writer_write_frame(SlopeY4mWriter *self, cairo_surface_t *image);
+
+/* Frees the writer, returns the first error met */
+cairo_status_t _y4m_writer_finish(SlopeY4mWriter *self);
+
+#endif /* SLOPE_Y4M_P_H */
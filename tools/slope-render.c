@@ -0,0 +1,472 @@
+/*
+ * Copyright (C) 2017,2023  Elvis Teixeira, Anatoliy Sokolov
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* slope-render draws the figures described in one or more job files
+ * to PNG files, without a display. Jobs run concurrently, each
+ * worker thread keeps one image surface and cairo context and
+ * reuses it for every job of the same size.
+ *
+ * A job file is a key file where each group without a '/' in its
+ * name is a figure, and "<figure>/<series>" groups describe the
+ * series it lists. Relative paths are taken from the job file's
+ * directory:
+ *
+ *   [sine]
+ *   output=sine.png
+ *   width=800
+ *   height=600
+ *   title=Sine
+ *   x_title=t
+ *   y_title=sin(t)
+ *   series=measured;fit
+ *
+ *   [sine/measured]
+ *   data=measured.csv
+ *   style=kOr
+ *
+ *   [sine/fit]
+ *   data=fit.f64
+ *   style=b-
+ *
+ * Data files ending in .f64 hold native endian doubles as x,y pairs,
+ * anything else is read as text with an x and a y per line,
+ * separated by commas or blanks. Lines that do not start with a
+ * number are skipped.
+ *
+ * Outputs ending in .svg or .pdf are written as vector files, with
+ * the width and height in points.
+ *
+ * usage: slope-render [-j THREADS] JOBFILE...
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <slope/slope.h>
+
+/* bigger images go through slope_figure_write_to_png_stream() */
+#define RENDER_MAX_CANVAS_PIXELS (4096L * 4096L)
+
+typedef struct _RenderSeries
+{
+  char *  name;
+  char *  data_path;
+  char *  style;
+  double *x_vec;
+  double *y_vec;
+  long    n_pts;
+} RenderSeries;
+
+typedef struct _RenderJob
+{
+  char *     name;
+  char *     output;
+  int        width;
+  int        height;
+  char *     title;
+  char *     x_title;
+  char *     y_title;
+  GPtrArray *series;
+} RenderJob;
+
+typedef struct _RenderCanvas
+{
+  cairo_surface_t *surface;
+  cairo_t *        cr;
+} RenderCanvas;
+
+static void render_canvas_free(gpointer data);
+
+static GPrivate render_canvas = G_PRIVATE_INIT(render_canvas_free);
+static gint     render_n_failed = 0;
+static int      render_n_threads = 0;
+
+static GOptionEntry render_options[] = {
+  {"jobs", 'j', 0, G_OPTION_ARG_INT, &render_n_threads,
+   "Number of jobs rendered at once (default: one per processor)", "THREADS"},
+  {NULL, 0, 0, 0, NULL, NULL, NULL}
+};
+
+static void render_series_free(gpointer data)
+{
+  RenderSeries *series = data;
+  g_free(series->name);
+  g_free(series->data_path);
+  g_free(series->style);
+  g_free(series->x_vec);
+  g_free(series->y_vec);
+  g_free(series);
+}
+
+static void render_job_free(RenderJob *job)
+{
+  g_free(job->name);
+  g_free(job->output);
+  g_free(job->title);
+  g_free(job->x_title);
+  g_free(job->y_title);
+  g_ptr_array_free(job->series, TRUE);
+  g_free(job);
+}
+
+static void render_fail(const RenderJob *job, const char *message)
+{
+  g_printerr("slope-render: %s: %s\n", job->name, message);
+  g_atomic_int_inc(&render_n_failed);
+}
+
+static void render_canvas_free(gpointer data)
+{
+  RenderCanvas *canvas = data;
+  cairo_destroy(canvas->cr);
+  cairo_surface_destroy(canvas->surface);
+  g_free(canvas);
+}
+
+/* this thread's canvas, made again only when the size changes */
+static RenderCanvas *render_get_canvas(int width, int height)
+{
+  RenderCanvas *canvas = g_private_get(&render_canvas);
+  if (canvas != NULL
+      && cairo_image_surface_get_width(canvas->surface) == width
+      && cairo_image_surface_get_height(canvas->surface) == height)
+    {
+      return canvas;
+    }
+  canvas          = g_new(RenderCanvas, 1);
+  canvas->surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+  canvas->cr      = cairo_create(canvas->surface);
+  /* frees the previous one */
+  g_private_replace(&render_canvas, canvas);
+  return canvas;
+}
+
+static char *render_resolve_path(const char *dir, const char *path)
+{
+  if (path == NULL || g_path_is_absolute(path))
+    {
+      return g_strdup(path);
+    }
+  return g_build_filename(dir, path, NULL);
+}
+
+static gboolean render_load_f64(RenderSeries *series, const char *contents, gsize length)
+{
+  const double *pairs = (const double *) contents;
+  long          k;
+  series->n_pts = (long) (length / (2 * sizeof(double)));
+  series->x_vec = g_new(double, series->n_pts);
+  series->y_vec = g_new(double, series->n_pts);
+  for (k = 0; k < series->n_pts; ++k)
+    {
+      series->x_vec[k] = pairs[2 * k];
+      series->y_vec[k] = pairs[2 * k + 1];
+    }
+  return length % (2 * sizeof(double)) == 0;
+}
+
+static gboolean render_load_text(RenderSeries *series, char *contents)
+{
+  GArray *x_array = g_array_new(FALSE, FALSE, sizeof(double));
+  GArray *y_array = g_array_new(FALSE, FALSE, sizeof(double));
+  char *  line    = contents;
+  char *  next, *end;
+  double  x, y;
+
+  while (line != NULL && *line != '\0')
+    {
+      next = strchr(line, '\n');
+      if (next != NULL)
+        {
+          *next++ = '\0';
+        }
+      /* headers and comments do not parse as a number */
+      x = g_ascii_strtod(line, &end);
+      if (end != line)
+        {
+          line = end + strspn(end, " \t,;");
+          y    = g_ascii_strtod(line, &end);
+          if (end != line)
+            {
+              g_array_append_val(x_array, x);
+              g_array_append_val(y_array, y);
+            }
+        }
+      line = next;
+    }
+  series->n_pts = (long) x_array->len;
+  series->x_vec = (double *) g_array_free(x_array, FALSE);
+  series->y_vec = (double *) g_array_free(y_array, FALSE);
+  return TRUE;
+}
+
+static gboolean render_load_series(RenderSeries *series, GError **error)
+{
+  char *   contents;
+  gsize    length;
+  gboolean ok;
+  if (!g_file_get_contents(series->data_path, &contents, &length, error))
+    {
+      return FALSE;
+    }
+  if (g_str_has_suffix(series->data_path, ".f64"))
+    {
+      ok = render_load_f64(series, contents, length);
+    }
+  else
+    {
+      ok = render_load_text(series, contents);
+    }
+  g_free(contents);
+  /* a series needs at least one point */
+  return ok && series->n_pts > 0;
+}
+
+static cairo_status_t render_write_file(void *               file,
+                                        const unsigned char *data,
+                                        unsigned int         length)
+{
+  if (fwrite(data, 1, length, file) != length)
+    {
+      return CAIRO_STATUS_WRITE_ERROR;
+    }
+  return CAIRO_STATUS_SUCCESS;
+}
+
+static gboolean render_write_png(SlopeFigure *figure, const RenderJob *job)
+{
+  RenderCanvas *canvas;
+  FILE *        file;
+  gboolean      ok;
+
+  if ((long) job->width * job->height > RENDER_MAX_CANVAS_PIXELS)
+    {
+      file = fopen(job->output, "wb");
+      if (file == NULL)
+        {
+          return FALSE;
+        }
+      ok = slope_figure_write_to_png_stream(
+          figure, render_write_file, file, job->width, job->height);
+      return (fclose(file) == 0) && ok;
+    }
+
+  canvas = render_get_canvas(job->width, job->height);
+  if (cairo_surface_status(canvas->surface) != CAIRO_STATUS_SUCCESS)
+    {
+      return FALSE;
+    }
+  cairo_save(canvas->cr);
+  cairo_set_operator(canvas->cr, CAIRO_OPERATOR_CLEAR);
+  cairo_paint(canvas->cr);
+  cairo_restore(canvas->cr);
+  slope_figure_draw(figure,
+                    &GRAPHENE_RECT_INIT (0.0, 0.0, job->width, job->height),
+                    canvas->cr);
+  return cairo_surface_write_to_png(canvas->surface, job->output) == CAIRO_STATUS_SUCCESS;
+}
+
+static void render_job(gpointer data, gpointer user_data)
+{
+  RenderJob *  job = data;
+  SlopeFigure *figure;
+  SlopeScale * scale;
+  GError *     error = NULL;
+  gboolean     ok    = TRUE;
+  guint        k;
+  SLOPE_UNUSED(user_data);
+
+  figure = slope_figure_new();
+  slope_figure_set_frame_mode(figure, SLOPE_FIGURE_RECTANGLE);
+  scale = slope_xyscale_new_axis(job->x_title, job->y_title, job->title);
+  slope_figure_add_scale(figure, scale);
+
+  for (k = 0; k < job->series->len && ok; ++k)
+    {
+      RenderSeries *series = g_ptr_array_index(job->series, k);
+      ok = render_load_series(series, &error);
+      if (!ok)
+        {
+          render_fail(job, (error != NULL) ? error->message : series->data_path);
+          g_clear_error(&error);
+          break;
+        }
+      slope_scale_add_item(scale,
+                           slope_xyseries_new_filled(series->name,
+                                                     series->x_vec,
+                                                     series->y_vec,
+                                                     series->n_pts,
+                                                     series->style));
+    }
+  if (ok)
+    {
+      if (g_str_has_suffix(job->output, ".svg"))
+        {
+          ok = slope_figure_write_to_svg(figure, job->output, job->width, job->height);
+        }
+      else if (g_str_has_suffix(job->output, ".pdf"))
+        {
+          ok = slope_figure_write_to_pdf(figure, job->output, job->width, job->height);
+        }
+      else
+        {
+          ok = render_write_png(figure, job);
+        }
+      if (!ok)
+        {
+          render_fail(job, "could not write the output file");
+        }
+    }
+
+  /* the series borrow the data, the figure goes first */
+  g_object_unref(figure);
+  render_job_free(job);
+}
+
+static RenderJob *render_parse_job(GKeyFile *  key_file,
+                                   const char *group,
+                                   const char *dir)
+{
+  RenderJob *job = g_new0(RenderJob, 1);
+  char *     output;
+  char **    names;
+  gsize      n_names, k;
+
+  job->name   = g_strdup(group);
+  job->series = g_ptr_array_new_with_free_func(render_series_free);
+  output      = g_key_file_get_string(key_file, group, "output", NULL);
+  job->output = render_resolve_path(dir, output);
+  g_free(output);
+  job->width = g_key_file_has_key(key_file, group, "width", NULL)
+                   ? g_key_file_get_integer(key_file, group, "width", NULL) : 800;
+  job->height = g_key_file_has_key(key_file, group, "height", NULL)
+                    ? g_key_file_get_integer(key_file, group, "height", NULL) : 600;
+  job->title   = g_key_file_get_string(key_file, group, "title", NULL);
+  job->x_title = g_key_file_get_string(key_file, group, "x_title", NULL);
+  job->y_title = g_key_file_get_string(key_file, group, "y_title", NULL);
+  if (job->output == NULL || job->width <= 0 || job->height <= 0)
+    {
+      render_fail(job, "needs an output and a positive size");
+      render_job_free(job);
+      return NULL;
+    }
+
+  names = g_key_file_get_string_list(key_file, group, "series", &n_names, NULL);
+  for (k = 0; names != NULL && k < n_names; ++k)
+    {
+      RenderSeries *series       = g_new0(RenderSeries, 1);
+      char *        series_group = g_strdup_printf("%s/%s", group, names[k]);
+      char *        data_path;
+      series->name  = g_strdup(names[k]);
+      data_path     = g_key_file_get_string(key_file, series_group, "data", NULL);
+      series->style = g_key_file_get_string(key_file, series_group, "style", NULL);
+      series->data_path = render_resolve_path(dir, data_path);
+      g_free(data_path);
+      g_free(series_group);
+      g_ptr_array_add(job->series, series);
+      if (series->data_path == NULL)
+        {
+          render_fail(job, "a series has no data file");
+          g_strfreev(names);
+          render_job_free(job);
+          return NULL;
+        }
+      if (series->style == NULL)
+        {
+          series->style = g_strdup("b-");
+        }
+    }
+  g_strfreev(names);
+  return job;
+}
+
+static void render_queue_file(GThreadPool *pool, const char *path)
+{
+  GKeyFile *key_file = g_key_file_new();
+  GError *  error    = NULL;
+  char **   groups;
+  char *    dir;
+  gsize     k;
+
+  if (!g_key_file_load_from_file(key_file, path, G_KEY_FILE_NONE, &error))
+    {
+      g_printerr("slope-render: %s: %s\n", path, error->message);
+      g_error_free(error);
+      g_key_file_free(key_file);
+      g_atomic_int_inc(&render_n_failed);
+      return;
+    }
+  dir    = g_path_get_dirname(path);
+  groups = g_key_file_get_groups(key_file, NULL);
+  for (k = 0; groups[k] != NULL; ++k)
+    {
+      RenderJob *job;
+      if (strchr(groups[k], '/') != NULL)
+        {
+          continue;
+        }
+      job = render_parse_job(key_file, groups[k], dir);
+      if (job != NULL)
+        {
+          g_thread_pool_push(pool, job, NULL);
+        }
+    }
+  g_strfreev(groups);
+  g_free(dir);
+  g_key_file_free(key_file);
+}
+
+int main(int argc, char *argv[])
+{
+  GOptionContext *context;
+  GThreadPool *   pool;
+  GError *        error = NULL;
+  int             k;
+
+  context = g_option_context_new("JOBFILE... - render slope figures to PNG files");
+  g_option_context_add_main_entries(context, render_options, NULL);
+  if (!g_option_context_parse(context, &argc, &argv, &error))
+    {
+      g_printerr("slope-render: %s\n", error->message);
+      g_error_free(error);
+      g_option_context_free(context);
+      return 2;
+    }
+  g_option_context_free(context);
+  if (argc < 2)
+    {
+      g_printerr("usage: slope-render [-j THREADS] JOBFILE...\n");
+      return 2;
+    }
+  if (render_n_threads <= 0)
+    {
+      render_n_threads = (int) g_get_num_processors();
+    }
+
+  pool = g_thread_pool_new(render_job, NULL, render_n_threads, TRUE, NULL);
+  for (k = 1; k < argc; ++k)
+    {
+      render_queue_file(pool, argv[k]);
+    }
+  /* waits for the queued jobs to finish */
+  g_thread_pool_free(pool, FALSE, TRUE);
+
+  return (g_atomic_int_get(&render_n_failed) == 0) ? 0 : 1;
+}